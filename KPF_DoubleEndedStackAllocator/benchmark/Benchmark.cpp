@@ -0,0 +1,348 @@
+/**
+* Microbenchmarks for the DoubleEndedStackAllocator
+* Measures ns per operation and memory overhead of different policy configurations
+* and compares them with malloc and the std::pmr resources as baselines
+*
+* Needs C++17 (std::pmr), build with "make benchmark"
+* Usage: DoubleEndedStackAllocatorBenchmark [repetitions]
+* All workloads are generated from a fixed seed before measuring, so numbers are reproducible between runs
+**/
+
+#include "DoubleEndedStackAllocator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <memory_resource>
+#include <random>
+#include <vector>
+
+namespace Benchmark
+{
+	const size_t ARENA_SIZE = 512 * 1024 * 1024;
+
+	struct Request
+	{
+		size_t Size;
+		size_t Alignment;
+	};
+
+	struct Workload
+	{
+		const char* Name;
+		std::vector<Request> Requests;
+	};
+
+	// Sizes and alignments are drawn from [minSize, maxSize] and 2^[minAlignLog, maxAlignLog]
+	Workload MakeWorkload(const char* name, size_t count, size_t minSize, size_t maxSize, size_t minAlignLog, size_t maxAlignLog)
+	{
+		std::mt19937 random(42);
+		std::uniform_int_distribution<size_t> sizes(minSize, maxSize);
+		std::uniform_int_distribution<size_t> alignments(minAlignLog, maxAlignLog);
+
+		Workload workload{ name, {} };
+		workload.Requests.reserve(count);
+		for (size_t i = 0; i < count; ++i)
+		{
+			workload.Requests.push_back(Request{ sizes(random), size_t(1) << alignments(random) });
+		}
+		return workload;
+	}
+
+	// Adapters give every allocator the same interface
+	// Free gets size and alignment because the pool resource needs them, FreeAll releases everything at once
+	template<class A>
+	struct StackAdapter
+	{
+		static const bool SUPPORTS_FREE = A::SUPPORTS_FREE;
+
+		StackAdapter(void)
+			: Allocator(ARENA_SIZE, ARENA_SIZE)
+		{
+		}
+
+		void* Allocate(const Request& request) { return Allocator.Allocate(request.Size, request.Alignment); }
+		void* AllocateBack(const Request& request) { return Allocator.AllocateBack(request.Size, request.Alignment); }
+		void Free(void* memory, const Request&) { Allocator.Free(memory); }
+		void FreeBack(void* memory, const Request&) { Allocator.FreeBack(memory); }
+		void FreeAll(void**, const Request*, size_t) { Allocator.Reset(); }
+
+		// Bytes between begin and top of both stacks plus out-of-line records, compared with the requested bytes this is the overhead
+		size_t GetUsedSize(void) const { return Allocator.GetUsedSize() + Allocator.GetStats().MetaTableBytes; }
+
+		typename A::Type Allocator;
+	};
+
+	template<class BoundsCheck, class MetaData, class Growth>
+	struct StackConfig
+	{
+		using Type = DoubleEndedStackAllocatorT<BoundsCheck, MetaData, Growth, IgnoreErrors>;
+		static const bool SUPPORTS_FREE = MetaData::SUPPORTS_FREE;
+	};
+
+	struct MallocAdapter
+	{
+		static const bool SUPPORTS_FREE = true;
+
+		void* Allocate(const Request& request) { return aligned_alloc(request.Alignment, (request.Size + request.Alignment - 1) & ~(request.Alignment - 1)); }
+		void* AllocateBack(const Request& request) { return Allocate(request); }
+		void Free(void* memory, const Request&) { free(memory); }
+		void FreeBack(void* memory, const Request&) { free(memory); }
+		void FreeAll(void** memory, const Request*, size_t count)
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				free(memory[i]);
+			}
+		}
+		size_t GetUsedSize(void) const { return 0; }
+	};
+
+	struct MonotonicAdapter
+	{
+		static const bool SUPPORTS_FREE = false;
+
+		void* Allocate(const Request& request) { return Resource.allocate(request.Size, request.Alignment); }
+		void* AllocateBack(const Request& request) { return Allocate(request); }
+		void Free(void*, const Request&) {}
+		void FreeBack(void*, const Request&) {}
+		void FreeAll(void**, const Request*, size_t) { Resource.release(); }
+		size_t GetUsedSize(void) const { return 0; }
+
+		std::pmr::monotonic_buffer_resource Resource;
+	};
+
+	struct PoolAdapter
+	{
+		static const bool SUPPORTS_FREE = true;
+
+		void* Allocate(const Request& request) { return Resource.allocate(request.Size, request.Alignment); }
+		void* AllocateBack(const Request& request) { return Allocate(request); }
+		void Free(void* memory, const Request& request) { Resource.deallocate(memory, request.Size, request.Alignment); }
+		void FreeBack(void* memory, const Request& request) { Free(memory, request); }
+		void FreeAll(void** memory, const Request* requests, size_t count)
+		{
+			for (size_t i = count; i > 0; --i)
+			{
+				Resource.deallocate(memory[i - 1], requests[i - 1].Size, requests[i - 1].Alignment);
+			}
+		}
+		size_t GetUsedSize(void) const { return 0; }
+
+		std::pmr::unsynchronized_pool_resource Resource;
+	};
+
+	struct Result
+	{
+		double NsPerOp = 0.0;
+		size_t UsedSize = 0;
+		bool Failed = false;
+	};
+
+	// Touch every allocation, so the allocators can't skip committing memory and the compiler can't remove anything
+	inline void Touch(void* memory, size_t index)
+	{
+		*static_cast<volatile char*>(memory) = static_cast<char>(index);
+	}
+
+	using Clock = std::chrono::steady_clock;
+
+	// Allocate and immediately free again, the steady state of a scratch allocation
+	template<class A>
+	Result RunAllocateFree(A& allocator, const Workload& workload)
+	{
+		Result result;
+		const Clock::time_point start = Clock::now();
+		for (size_t i = 0; i < workload.Requests.size(); ++i)
+		{
+			void* memory = allocator.Allocate(workload.Requests[i]);
+			if (!memory)
+			{
+				result.Failed = true;
+				break;
+			}
+			Touch(memory, i);
+			allocator.Free(memory, workload.Requests[i]);
+		}
+		result.NsPerOp = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / workload.Requests.size();
+		return result;
+	}
+
+	// Allocate all requests and release them at once (Reset for the stack allocators)
+	// backRatio: every n-th allocation goes to the back stack, 0 for front only
+	// A failed allocation stops the run, only the allocations made so far are released
+	template<class A>
+	Result RunBurstReset(A& allocator, const Workload& workload, std::vector<void*>& pointers, size_t backRatio)
+	{
+		Result result;
+		const Clock::time_point start = Clock::now();
+		size_t count = 0;
+		for (; count < workload.Requests.size(); ++count)
+		{
+			const bool back = backRatio && (count % backRatio) == 0;
+			void* memory = back ? allocator.AllocateBack(workload.Requests[count]) : allocator.Allocate(workload.Requests[count]);
+			if (!memory)
+			{
+				result.Failed = true;
+				break;
+			}
+			Touch(memory, count);
+			pointers[count] = memory;
+		}
+		result.UsedSize = allocator.GetUsedSize();
+		allocator.FreeAll(pointers.data(), workload.Requests.data(), count);
+		result.NsPerOp = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / workload.Requests.size();
+		return result;
+	}
+
+	// Allocate all requests on the back stack and free them one by one in LIFO order
+	template<class A>
+	Result RunBurstLifo(A& allocator, const Workload& workload, std::vector<void*>& pointers)
+	{
+		Result result;
+		const Clock::time_point start = Clock::now();
+		size_t count = 0;
+		for (; count < workload.Requests.size(); ++count)
+		{
+			void* memory = allocator.AllocateBack(workload.Requests[count]);
+			if (!memory)
+			{
+				result.Failed = true;
+				break;
+			}
+			Touch(memory, count);
+			pointers[count] = memory;
+		}
+		result.UsedSize = allocator.GetUsedSize();
+		for (size_t i = count; i > 0; --i)
+		{
+			allocator.FreeBack(pointers[i - 1], workload.Requests[i - 1]);
+		}
+		result.NsPerOp = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / workload.Requests.size();
+		return result;
+	}
+
+	enum class Scenario
+	{
+		AllocateFree,
+		BurstReset,
+		BurstMixedEnds,
+		BurstLifoBack
+	};
+
+	const char* GetScenarioName(Scenario scenario)
+	{
+		switch (scenario)
+		{
+		case Scenario::AllocateFree: return "allocate+free";
+		case Scenario::BurstReset: return "burst+reset";
+		case Scenario::BurstMixedEnds: return "burst both ends+reset";
+		case Scenario::BurstLifoBack: return "burst back+lifo free";
+		}
+		return "";
+	}
+
+	size_t GetRequestedSize(const Workload& workload)
+	{
+		size_t size = 0;
+		for (const Request& request : workload.Requests)
+		{
+			size += request.Size;
+		}
+		return size;
+	}
+
+	// Runs a scenario several times on the same allocator and reports the fastest run
+	// An untimed first run faults in the memory, so no allocator pays for first-touch page faults in the timings
+	template<class A>
+	void Run(const char* name, Scenario scenario, const Workload& workload, size_t repetitions)
+	{
+		const bool needsFree = scenario == Scenario::AllocateFree || scenario == Scenario::BurstLifoBack;
+		if (needsFree && !A::SUPPORTS_FREE)
+		{
+			return;
+		}
+
+		std::vector<void*> pointers(workload.Requests.size());
+		std::unique_ptr<A> allocator(new A());
+		Result best;
+		best.NsPerOp = 1e300;
+		for (size_t i = 0; i <= repetitions; ++i)
+		{
+			Result result;
+			switch (scenario)
+			{
+			case Scenario::AllocateFree: result = RunAllocateFree(*allocator, workload); break;
+			case Scenario::BurstReset: result = RunBurstReset(*allocator, workload, pointers, 0); break;
+			case Scenario::BurstMixedEnds: result = RunBurstReset(*allocator, workload, pointers, 2); break;
+			case Scenario::BurstLifoBack: result = RunBurstLifo(*allocator, workload, pointers); break;
+			}
+			best.Failed |= result.Failed;
+			if (i > 0 && result.NsPerOp < best.NsPerOp)
+			{
+				best.NsPerOp = result.NsPerOp;
+				best.UsedSize = result.UsedSize;
+			}
+		}
+
+		printf("%-22s %-24s %-34s %10.2f %10.2f", workload.Name, GetScenarioName(scenario), name, best.NsPerOp, 1e3 / best.NsPerOp);
+		if (best.UsedSize)
+		{
+			const size_t requested = GetRequestedSize(workload);
+			printf(" %9.1f%%", 100.0 * (double(best.UsedSize) - double(requested)) / double(requested));
+		}
+		else
+		{
+			printf(" %10s", "-");
+		}
+		printf("%s\n", best.Failed ? "  (allocation failed)" : "");
+	}
+
+	template<class BoundsCheck, class MetaData, class Growth>
+	using Stack = StackAdapter<StackConfig<BoundsCheck, MetaData, Growth>>;
+
+	void RunAll(Scenario scenario, const Workload& workload, size_t repetitions)
+	{
+		Run<Stack<CanaryBoundsCheck, InlineMetaData, MallocGrowth>>("stack canaries, fixed", scenario, workload, repetitions);
+		Run<Stack<CanaryBoundsCheck, InlineMetaData, VirtualMemoryGrowth>>("stack canaries, grow", scenario, workload, repetitions);
+		Run<Stack<NoBoundsCheck, InlineMetaData, MallocGrowth>>("stack no canaries, fixed", scenario, workload, repetitions);
+		Run<Stack<NoBoundsCheck, InlineMetaData, VirtualMemoryGrowth>>("stack no canaries, grow", scenario, workload, repetitions);
+		Run<Stack<NoBoundsCheck, SideTableMetaData, VirtualMemoryGrowth>>("stack side table, grow", scenario, workload, repetitions);
+		Run<Stack<NoBoundsCheck, NoMetaData, VirtualMemoryGrowth>>("frame arena (no header), grow", scenario, workload, repetitions);
+		Run<MallocAdapter>("malloc", scenario, workload, repetitions);
+		Run<MonotonicAdapter>("pmr::monotonic_buffer_resource", scenario, workload, repetitions);
+		Run<PoolAdapter>("pmr::unsync_pool_resource", scenario, workload, repetitions);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const size_t repetitions = argc > 1 ? std::max(1, atoi(argv[1])) : 5;
+
+	const Benchmark::Workload workloads[] =
+	{
+		Benchmark::MakeWorkload("16B align 8", 200000, 16, 16, 3, 3),
+		Benchmark::MakeWorkload("8-64B align 8", 200000, 8, 64, 3, 3),
+		Benchmark::MakeWorkload("8-256B align 1-64", 200000, 8, 256, 0, 6),
+		Benchmark::MakeWorkload("4-64KiB align 16", 4000, 4 * 1024, 64 * 1024, 4, 4),
+	};
+	const Benchmark::Scenario scenarios[] =
+	{
+		Benchmark::Scenario::AllocateFree,
+		Benchmark::Scenario::BurstReset,
+		Benchmark::Scenario::BurstMixedEnds,
+		Benchmark::Scenario::BurstLifoBack,
+	};
+
+	printf("Best of %zu runs, overhead = (used bytes - requested bytes) / requested bytes\n", repetitions);
+	printf("%-22s %-24s %-34s %10s %10s %10s\n", "workload", "scenario", "allocator", "ns/op", "Mops/s", "overhead");
+	for (const Benchmark::Workload& workload : workloads)
+	{
+		for (Benchmark::Scenario scenario : scenarios)
+		{
+			Benchmark::RunAll(scenario, workload, repetitions);
+		}
+		printf("\n");
+	}
+	return 0;
+}
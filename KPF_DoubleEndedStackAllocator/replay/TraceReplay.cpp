@@ -0,0 +1,253 @@
+/**
+* Replays an allocation trace recorded with RingBufferTrace (see RingBufferTrace::WriteTo)
+* Feeds the recorded stream through different allocator configurations and malloc and reports
+* time per operation, failed allocations and the peak footprint
+*
+* Build with "make replay"
+* Usage: TraceReplay <trace file> [arena size in bytes] [repetitions]
+* The arena size defaults to 1 GiB, a smaller one reproduces overlap failures of a smaller arena
+**/
+
+#include "DoubleEndedStackAllocator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+namespace Replay
+{
+	struct Live
+	{
+		void* Memory;
+		size_t Size;
+	};
+
+	template<class BoundsCheck, class Growth>
+	struct StackAdapter
+	{
+		using Type = DoubleEndedStackAllocatorT<BoundsCheck, InlineMetaData, Growth, IgnoreErrors, CollectStats>;
+
+		explicit StackAdapter(size_t arenaSize)
+			: Allocator(arenaSize, arenaSize)
+		{
+		}
+
+		void* Allocate(End side, size_t size, size_t alignment)
+		{
+			return side == End::Front ? Allocator.Allocate(size, alignment) : Allocator.AllocateBack(size, alignment);
+		}
+
+		void* Reallocate(End side, const Live& live, size_t size, size_t alignment)
+		{
+			return side == End::Front ? Allocator.Reallocate(live.Memory, size, alignment) : Allocator.ReallocateBack(live.Memory, size, alignment);
+		}
+
+		void Free(End side, const Live& live)
+		{
+			if (side == End::Front)
+			{
+				Allocator.Free(live.Memory);
+			}
+			else
+			{
+				Allocator.FreeBack(live.Memory);
+			}
+		}
+
+		void Reset(End side, std::vector<Live>&)
+		{
+			if (side == End::Front)
+			{
+				Allocator.ResetFront();
+			}
+			else
+			{
+				Allocator.ResetBack();
+			}
+		}
+
+		size_t GetUsedSize(void) const { return Allocator.GetUsedSize(); }
+		size_t GetCommittedSize(void) const { return Allocator.GetCommittedSize(); }
+
+		Type Allocator;
+	};
+
+	// Footprint of malloc is the sum of the live requested sizes, its own overhead is unknown
+	struct MallocAdapter
+	{
+		explicit MallocAdapter(size_t)
+		{
+		}
+
+		void* Allocate(End, size_t size, size_t alignment)
+		{
+			void* memory = aligned_alloc(alignment, (size + alignment - 1) & ~(alignment - 1));
+			Used += memory ? size : 0;
+			return memory;
+		}
+
+		void* Reallocate(End side, const Live& live, size_t size, size_t alignment)
+		{
+			void* memory = Allocate(side, size, alignment);
+			if (memory)
+			{
+				memcpy(memory, live.Memory, std::min(size, live.Size));
+				Free(side, live);
+			}
+			return memory;
+		}
+
+		void Free(End, const Live& live)
+		{
+			free(live.Memory);
+			Used -= live.Size;
+		}
+
+		void Reset(End side, std::vector<Live>& stack)
+		{
+			for (const Live& live : stack)
+			{
+				if (live.Memory)
+				{
+					Free(side, live);
+				}
+			}
+		}
+
+		size_t GetUsedSize(void) const { return Used; }
+		size_t GetCommittedSize(void) const { return 0; }
+
+		size_t Used = 0;
+	};
+
+	struct Result
+	{
+		double NsPerOp = 0.0;
+		size_t Failed = 0;
+		size_t PeakUsed = 0;
+		size_t Committed = 0;
+	};
+
+	using Clock = std::chrono::steady_clock;
+
+	// Free and Reset always refer to the top or the whole stack, so the replay only needs one stack of live allocations per end
+	// The peak is only measured in an untimed run, because it needs GetUsedSize after every operation
+	template<class A>
+	Result Run(const std::vector<TraceEvent>& events, size_t arenaSize, bool measurePeak)
+	{
+		A allocator(arenaSize);
+		std::vector<Live> stacks[2];
+		stacks[0].reserve(events.size());
+		stacks[1].reserve(events.size());
+
+		Result result;
+		const Clock::time_point start = Clock::now();
+		for (const TraceEvent& event : events)
+		{
+			const End side = static_cast<End>(event.Side);
+			std::vector<Live>& stack = stacks[event.Side & 1];
+			switch (static_cast<TraceOp>(event.Op))
+			{
+			case TraceOp::Allocate:
+			case TraceOp::Reallocate:
+			{
+				// Failed allocations stay on the stack as placeholder, so the following frees still match the recorded ones
+				// Reallocating a placeholder allocates fresh memory in its place, a failed resize keeps the old allocation
+				const bool replace = event.Op == static_cast<uint8_t>(TraceOp::Reallocate) && !stack.empty();
+				const bool resize = replace && stack.back().Memory;
+				void* memory = resize ? allocator.Reallocate(side, stack.back(), event.Size, event.Alignment) : allocator.Allocate(side, event.Size, event.Alignment);
+				result.Failed += memory ? 0 : 1;
+				if (!replace)
+				{
+					stack.push_back(Live{ memory, event.Size });
+				}
+				else if (memory || !resize)
+				{
+					stack.back() = Live{ memory, event.Size };
+				}
+				break;
+			}
+			case TraceOp::Free:
+				if (!stack.empty())
+				{
+					if (stack.back().Memory)
+					{
+						allocator.Free(side, stack.back());
+					}
+					stack.pop_back();
+				}
+				break;
+			case TraceOp::Reset:
+				allocator.Reset(side, stack);
+				stack.clear();
+				break;
+			}
+			if (measurePeak)
+			{
+				result.PeakUsed = std::max(result.PeakUsed, allocator.GetUsedSize());
+			}
+		}
+		result.NsPerOp = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / events.size();
+		result.Committed = allocator.GetCommittedSize();
+
+		allocator.Reset(End::Front, stacks[0]);
+		allocator.Reset(End::Back, stacks[1]);
+		return result;
+	}
+
+	template<class A>
+	void Report(const char* name, const std::vector<TraceEvent>& events, size_t arenaSize, size_t repetitions)
+	{
+		Result best = Run<A>(events, arenaSize, true);
+		best.NsPerOp = 1e300;
+		for (size_t i = 0; i < repetitions; ++i)
+		{
+			best.NsPerOp = std::min(best.NsPerOp, Run<A>(events, arenaSize, false).NsPerOp);
+		}
+		printf("%-28s %10.2f %10zu %14zu %14zu\n", name, best.NsPerOp, best.Failed, best.PeakUsed, best.Committed);
+	}
+
+	bool Load(const char* path, std::vector<TraceEvent>& events)
+	{
+		FILE* file = fopen(path, "rb");
+		if (!file)
+		{
+			return false;
+		}
+		TraceEvent chunk[256];
+		size_t count = 0;
+		while ((count = fread(chunk, sizeof(TraceEvent), 256, file)) > 0)
+		{
+			events.insert(events.end(), chunk, chunk + count);
+		}
+		fclose(file);
+		return true;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 2)
+	{
+		printf("Usage: %s <trace file> [arena size in bytes] [repetitions]\n", argv[0]);
+		return 1;
+	}
+
+	std::vector<TraceEvent> events;
+	if (!Replay::Load(argv[1], events) || events.empty())
+	{
+		printf(ANSI_COLOR_RED "[Error]" ANSI_COLOR_RESET ": Could not read any events from %s\n", argv[1]);
+		return 1;
+	}
+	const size_t arenaSize = argc > 2 ? static_cast<size_t>(strtoull(argv[2], nullptr, 10)) : VirtualMemoryGrowth::DEFAULT_RESERVE_SIZE;
+	const size_t repetitions = argc > 3 ? std::max(1, atoi(argv[3])) : 5;
+
+	printf("%zu events, arena %zu bytes, best of %zu runs\n", events.size(), arenaSize, repetitions);
+	printf("%-28s %10s %10s %14s %14s\n", "allocator", "ns/op", "failed", "peak bytes", "committed");
+	Replay::Report<Replay::StackAdapter<CanaryBoundsCheck, MallocGrowth>>("stack canaries, fixed", events, arenaSize, repetitions);
+	Replay::Report<Replay::StackAdapter<NoBoundsCheck, MallocGrowth>>("stack no canaries, fixed", events, arenaSize, repetitions);
+	Replay::Report<Replay::StackAdapter<NoBoundsCheck, VirtualMemoryGrowth>>("stack no canaries, grow", events, arenaSize, repetitions);
+	Replay::Report<Replay::MallocAdapter>("malloc", events, arenaSize, repetitions);
+	return 0;
+}
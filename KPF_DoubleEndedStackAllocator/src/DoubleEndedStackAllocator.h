@@ -0,0 +1,4046 @@
+/**
+* DoubleEndedStackAllocator: two stacks growing towards each other in one block of memory
+* Group members: Handl Anja (gs20m005), Tributsch Harald (gs20m008), Leithner Michael (gs20m012)
+*
+* The allocator itself is a template over policies (DoubleEndedStackAllocatorT), the defines below select the
+* policies of the default DoubleEndedStackAllocator and can be set before including this header
+* The growable version uses VirtualAlloc on Windows and mmap/mprotect on POSIX systems
+**/
+
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+// std::pmr adapters need C++17 and <memory_resource>, the STL allocator adapter works without them
+#ifndef HTL_HAS_PMR
+#if defined(__has_include)
+#if __has_include(<memory_resource>) && ((defined(_MSVC_LANG) && _MSVC_LANG >= 201703L) || __cplusplus >= 201703L)
+#define HTL_HAS_PMR				1
+#endif
+#endif
+#endif
+#ifndef HTL_HAS_PMR
+#define HTL_HAS_PMR				0
+#endif
+#if HTL_HAS_PMR
+#include <memory_resource>
+#endif
+
+#ifndef WITH_DEBUG_CANARIES
+#define WITH_DEBUG_CANARIES		1	// Enables/Disables writing and checking of canaries
+#endif
+#ifndef HTL_ALLOW_GROW
+#define HTL_ALLOW_GROW			1	// Enables/Disables growing by using virtual memory
+#endif
+#ifndef HTL_PRINT_ERRORS
+#define HTL_PRINT_ERRORS		1	// Enables/Disables Printing of error outputs
+#endif
+#ifndef HTL_WITH_STATS
+#define HTL_WITH_STATS			0	// Enables/Disables collecting usage statistics
+#endif
+#ifndef HTL_WITH_TRACE
+#define HTL_WITH_TRACE			0	// Enables/Disables recording allocations into a trace ring buffer
+#endif
+#ifndef HTL_WITH_DEBUG_OUTPUT
+#define HTL_WITH_DEBUG_OUTPUT	0	// Enables/Disables Debug output from us
+#endif
+
+// Color defines for error output
+#ifndef ANSI_COLOR_RED
+#define ANSI_COLOR_RED     "\x1b[31m"
+#define ANSI_COLOR_GREEN   "\x1b[32m"
+#define ANSI_COLOR_RESET   "\x1b[0m"
+#endif
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
+#endif
+
+// Define Custom output for cleaner code
+#if HTL_WITH_DEBUG_OUTPUT
+#define HTL_DEBUG(...) \
+	printf("[INFO]: "); \
+	printf(__VA_ARGS__); \
+	printf("\n");
+#else
+#define HTL_DEBUG(...)
+#endif
+
+// Failure paths are kept out of line, so they don't bloat the allocation functions and don't block inlining
+#if defined(__GNUC__) || defined(__clang__)
+#define HTL_COLD __attribute__((cold, noinline))
+#define HTL_UNLIKELY(x) __builtin_expect(!!(x), 0)
+#elif defined(_MSC_VER)
+#define HTL_COLD __declspec(noinline)
+#define HTL_UNLIKELY(x) (x)
+#else
+#define HTL_COLD
+#define HTL_UNLIKELY(x) (x)
+#endif
+
+// Sanitizer builds poison released stack memory, so ASan reports accesses to freed allocations like for the heap
+#if defined(__SANITIZE_ADDRESS__)
+#define HTL_ASAN 1
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define HTL_ASAN 1
+#endif
+#endif
+#if defined(HTL_ASAN)
+#include <sanitizer/asan_interface.h>
+#define HTL_POISON_MEMORY(address, size) ASAN_POISON_MEMORY_REGION(reinterpret_cast<void*>(address), size)
+#define HTL_UNPOISON_MEMORY(address, size) ASAN_UNPOISON_MEMORY_REGION(reinterpret_cast<void*>(address), size)
+#else
+#define HTL_POISON_MEMORY(address, size) ((void)(address), (void)(size))
+#define HTL_UNPOISON_MEMORY(address, size) ((void)(address), (void)(size))
+#endif
+
+// Thin platform layer for virtual memory, so the allocator itself doesn't have to care about the OS
+// Windows uses VirtualAlloc/VirtualFree, everything else is expected to be POSIX (mmap/mprotect/munmap)
+namespace VirtualMemory
+{
+	inline size_t GetPageSize()
+	{
+#if defined(_WIN32)
+		SYSTEM_INFO si;
+		GetSystemInfo(&si);
+		return si.dwPageSize;
+		// -> PageSize 4096 bytes, allocation granularity 65536
+#else
+		long pageSize = sysconf(_SC_PAGESIZE);
+		return pageSize > 0 ? static_cast<size_t>(pageSize) : 4096;
+#endif
+	}
+
+	// Size of a transparent huge page, 0 if huge pages are not available or disabled
+	// Windows large pages need SeLockMemoryPrivilege and can't be committed lazily, so they are not used
+	inline size_t GetHugePageSize()
+	{
+#if !defined(_WIN32) && defined(MADV_HUGEPAGE)
+		char buffer[64] = {};
+		FILE* file = fopen("/sys/kernel/mm/transparent_hugepage/enabled", "r");
+		if (!file)
+		{
+			return 0;
+		}
+		size_t read = fread(buffer, 1, sizeof(buffer) - 1, file);
+		fclose(file);
+		if (read == 0 || strstr(buffer, "[never]"))
+		{
+			return 0;
+		}
+
+		size_t hugePageSize = 2 * 1024 * 1024;
+		file = fopen("/sys/kernel/mm/transparent_hugepage/hpage_pmd_size", "r");
+		if (file)
+		{
+			unsigned long long size = 0;
+			if (fscanf(file, "%llu", &size) == 1 && size > 0)
+			{
+				hugePageSize = static_cast<size_t>(size);
+			}
+			fclose(file);
+		}
+		return hugePageSize;
+#else
+		return 0;
+#endif
+	}
+
+	// Reserves address space without backing it with physical memory
+	// Returns nullptr if the reservation failed
+	inline void* Reserve(size_t size)
+	{
+#if defined(_WIN32)
+		// PAGE_NOACCESS for no access protection until pages are commited
+		return VirtualAlloc(NULL, size, MEM_RESERVE, PAGE_NOACCESS);
+#else
+		// PROT_NONE works like PAGE_NOACCESS, MAP_NORESERVE prevents accounting the whole range up front
+		void* begin = mmap(nullptr, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+		return begin == MAP_FAILED ? nullptr : begin;
+#endif
+	}
+
+	// Reserves address space aligned to the huge page size and marks it for transparent huge pages
+	// size has to be a multiple of hugePageSize, returns nullptr if huge pages can't be used
+	inline void* ReserveHugePages(size_t size, size_t hugePageSize)
+	{
+#if !defined(_WIN32) && defined(MADV_HUGEPAGE)
+		// mmap only guarantees page alignment, so reserve one huge page more and cut off the unaligned head and tail
+		void* reserved = mmap(nullptr, size + hugePageSize, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+		if (reserved == MAP_FAILED)
+		{
+			return nullptr;
+		}
+		uintptr_t begin = reinterpret_cast<uintptr_t>(reserved);
+		uintptr_t alignedBegin = (begin + hugePageSize - 1) & ~(hugePageSize - 1);
+		if (alignedBegin > begin)
+		{
+			munmap(reserved, alignedBegin - begin);
+		}
+		if (begin + hugePageSize > alignedBegin)
+		{
+			munmap(reinterpret_cast<void*>(alignedBegin + size), begin + hugePageSize - alignedBegin);
+		}
+
+		if (madvise(reinterpret_cast<void*>(alignedBegin), size, MADV_HUGEPAGE) != 0)
+		{
+			munmap(reinterpret_cast<void*>(alignedBegin), size);
+			return nullptr;
+		}
+		return reinterpret_cast<void*>(alignedBegin);
+#else
+		(void)size;
+		(void)hugePageSize;
+		return nullptr;
+#endif
+	}
+
+	// Commits all pages touched by [address, address + size) as read/write memory
+	// Same as VirtualAlloc, returns the page aligned base address of the committed range or nullptr on failure
+	inline void* Commit(void* address, size_t size, size_t pageSize)
+	{
+#if defined(_WIN32)
+		(void)pageSize;
+		return VirtualAlloc(address, size, MEM_COMMIT, PAGE_READWRITE);
+#else
+		uintptr_t begin = reinterpret_cast<uintptr_t>(address) & ~(pageSize - 1);
+		uintptr_t end = (reinterpret_cast<uintptr_t>(address) + size + pageSize - 1) & ~(pageSize - 1);
+		if (mprotect(reinterpret_cast<void*>(begin), end - begin, PROT_READ | PROT_WRITE) != 0)
+		{
+			return nullptr;
+		}
+		return reinterpret_cast<void*>(begin);
+#endif
+	}
+
+	// Faults in all pages touched by [address, address + size), the range has to be committed
+	// Without MADV_POPULATE_WRITE every page is touched by writing back its own value, which is only allowed if
+	// nobody else writes to the range at the same time -> returns false instead if allowTouch is false
+	inline bool Populate(void* address, size_t size, size_t pageSize, bool allowTouch)
+	{
+		if (size == 0)
+		{
+			return true;
+		}
+#if !defined(_WIN32) && defined(MADV_POPULATE_WRITE)
+		if (madvise(address, size, MADV_POPULATE_WRITE) == 0)
+		{
+			return true;
+		}
+#endif
+		if (!allowTouch)
+		{
+			return false;
+		}
+
+		volatile char* begin = static_cast<volatile char*>(address);
+		volatile char* end = begin + size;
+		for (volatile char* page = begin; page < end; page += pageSize)
+		{
+			*page = *page;
+		}
+		*(end - 1) = *(end - 1);
+		return true;
+	}
+
+	// Gives the physical memory of all pages in [address, address + size) back to the system
+	// The range stays reserved and can be committed again, address and size have to be page aligned
+	inline bool Decommit(void* address, size_t size)
+	{
+#if defined(_WIN32)
+		return VirtualFree(address, size, MEM_DECOMMIT) != 0;
+#else
+		// MADV_DONTNEED drops the pages, PROT_NONE makes accesses fault like on an uncommitted Windows page
+		return madvise(address, size, MADV_DONTNEED) == 0
+			&& mprotect(address, size, PROT_NONE) == 0;
+#endif
+	}
+
+	// Makes committed pages inaccessible (guard pages) or read/write again, address and size have to be page aligned
+	inline bool Protect(void* address, size_t size, bool accessible)
+	{
+#if defined(_WIN32)
+		DWORD oldProtection = 0;
+		return VirtualProtect(address, size, accessible ? PAGE_READWRITE : PAGE_NOACCESS, &oldProtection) != 0;
+#else
+		return mprotect(address, size, accessible ? PROT_READ | PROT_WRITE : PROT_NONE) == 0;
+#endif
+	}
+
+	// Number of NUMA nodes (highest possible node id + 1), 1 if the system has no NUMA or it is not supported
+	inline int GetNumaNodeCount()
+	{
+#if defined(__linux__)
+		char buffer[256] = {};
+		FILE* file = fopen("/sys/devices/system/node/possible", "r");
+		if (!file)
+		{
+			return 1;
+		}
+		size_t read = fread(buffer, 1, sizeof(buffer) - 1, file);
+		fclose(file);
+
+		// Format is a list of ids and ranges like "0-3,6", the last number is the highest id
+		int highest = 0;
+		for (size_t i = 0; i < read;)
+		{
+			if (buffer[i] < '0' || buffer[i] > '9')
+			{
+				++i;
+				continue;
+			}
+			int id = 0;
+			for (; i < read && buffer[i] >= '0' && buffer[i] <= '9'; ++i)
+			{
+				id = id * 10 + (buffer[i] - '0');
+			}
+			highest = id > highest ? id : highest;
+		}
+		return highest + 1;
+#else
+		return 1;
+#endif
+	}
+
+	// NUMA node of the CPU the calling thread runs on right now, 0 if unknown
+	inline int GetCurrentNumaNode()
+	{
+#if defined(__linux__) && defined(SYS_getcpu)
+		unsigned cpu = 0;
+		unsigned node = 0;
+		if (syscall(SYS_getcpu, &cpu, &node, nullptr) == 0)
+		{
+			return static_cast<int>(node);
+		}
+#endif
+		return 0;
+	}
+
+	// Places all pages in [address, address + size) which are faulted in from now on on the given node
+	// strict fails page faults if the node is out of memory, otherwise other nodes are used as fallback
+	// Uses the raw mbind syscall, so no libnuma is needed. address has to be page aligned
+	inline bool BindToNumaNode(void* address, size_t size, int node, bool strict)
+	{
+#if defined(__linux__) && defined(SYS_mbind)
+		const int MPOL_PREFERRED_MODE = 1;
+		const int MPOL_BIND_MODE = 2;
+		const size_t BITS = 8 * sizeof(unsigned long);
+		unsigned long mask[1024 / BITS] = {};
+		if (node < 0 || static_cast<size_t>(node) >= 1024)
+		{
+			return false;
+		}
+		mask[node / BITS] = 1UL << (node % BITS);
+		return syscall(SYS_mbind, address, size, strict ? MPOL_BIND_MODE : MPOL_PREFERRED_MODE, mask, 1024, 0) == 0;
+#else
+		(void)address;
+		(void)size;
+		(void)node;
+		(void)strict;
+		return false;
+#endif
+	}
+
+	// Releases the whole reservation, size has to be the same as passed to Reserve
+	inline void Release(void* address, size_t size)
+	{
+#if defined(_WIN32)
+		(void)size;
+		VirtualFree(address, 0, MEM_RELEASE);
+#else
+		munmap(address, size);
+#endif
+	}
+}
+
+// Identifies one of the two stacks of the allocator
+enum class End
+{
+	Front,
+	Back
+};
+
+/**
+* Policies of the DoubleEndedStackAllocatorT
+* Every feature which costs memory or time per allocation is selected at compile time, so a checked debug arena
+* and a lean release arena can live in the same binary. The defines after namespace Tests only select the
+* policies of the default DoubleEndedStackAllocator.
+**/
+
+// Bounds check policies: write canaries around every allocation and check them on free
+// or place allocations from GUARD_THRESHOLD bytes on flush against an inaccessible guard page (0 = never)
+struct NoBoundsCheck
+{
+	static const bool ENABLED = false;
+	static const ptrdiff_t CANARY_SIZE = 0;
+	static const size_t GUARD_THRESHOLD = 0;
+
+	static void WriteCanary(uintptr_t) {}
+	static bool IsCanaryValid(uintptr_t) { return true; }
+};
+
+struct CanaryBoundsCheck
+{
+	static const bool ENABLED = true;
+	//static const uint32_t CANARY = 0xDEADC0DE;
+	static const uint32_t CANARY = 0xDEC0ADDE;	// Reverse, because little/big endian
+	static const ptrdiff_t CANARY_SIZE = sizeof(CANARY);
+	static const size_t GUARD_THRESHOLD = 0;
+
+	static void WriteCanary(uintptr_t canaryAddress)
+	{
+		//HTL_DEBUG("canaryAddress: [%llx]", canaryAddress);
+		*reinterpret_cast<uint32_t*>(canaryAddress) = CANARY;
+	}
+
+	static bool IsCanaryValid(uintptr_t canaryAddress)
+	{
+		return *reinterpret_cast<uint32_t*>(canaryAddress) == CANARY;
+	}
+};
+
+// Overruns fault right away in hardware instead of being found on free, without any canary bytes or stores
+// Front allocations end at the guard page, back allocations end below the guard page to the previous back allocation
+// Every guarded allocation costs a page of address space (a huge page with huge pages), only for growth policies on virtual memory
+template<size_t Threshold>
+struct GuardPageBoundsCheckT
+{
+	static const bool ENABLED = false;
+	static const ptrdiff_t CANARY_SIZE = 0;
+	static const size_t GUARD_THRESHOLD = Threshold;
+
+	static void WriteCanary(uintptr_t) {}
+	static bool IsCanaryValid(uintptr_t) { return true; }
+};
+
+// Large allocations only, small ones stay plain bump allocations
+using GuardPageBoundsCheck = GuardPageBoundsCheckT<64 * 1024>;
+// Every allocation, e.g. for staging builds
+using ParanoidGuardPageBoundsCheck = GuardPageBoundsCheckT<1>;
+
+// Meta data policies: how the LIFO chain (last item and size of every allocation) is stored
+// A record is needed for Free, without meta data only markers and Reset can release memory
+// Records are read by the address of the allocation and their depth in the stack (0 = last allocation)
+// With VERIFIES the allocator checks every freed record against the stack before it trusts it
+struct MetaRecord
+{
+	uintptr_t LastItem;
+	size_t Size;
+};
+
+// Stores the record as header directly in front of the user pointer
+struct InlineMetaData
+{
+	static const bool SUPPORTS_FREE = true;
+	static const bool VERIFIES = false;
+	static const ptrdiff_t META_SIZE = sizeof(MetaRecord);
+
+	bool Write(End, uintptr_t alignedAddress, uintptr_t lastItem, size_t allocatedSize)
+	{
+		uintptr_t metaAddress = alignedAddress - META_SIZE;
+		//HTL_DEBUG("metaAddress: [%llx]", metaAddress);
+		*reinterpret_cast<MetaRecord*>(metaAddress) = MetaRecord{ lastItem, allocatedSize };
+		return true;
+	}
+
+	MetaRecord Read(End, uintptr_t alignedAddress, size_t = 0) const
+	{
+		return *reinterpret_cast<MetaRecord*>(alignedAddress - META_SIZE);
+		// @Vogl How could we verify that MetaData struct is not corrupted?
+
+		// Possible ideas form our side:	Check if size is < (mEnd - mBegin)
+		//									LastItem needs to point to pointer in range (mBegin - mEnd)
+		//									LastItem needs to have valid meta data
+		// -> Done by CompactMetaData, see ValidateMetaRecord
+	}
+
+	void Pop(End) {}
+	void Clear(End) {}
+	size_t GetDepth(End) const { return 0; }
+	void FreeToDepth(End, size_t) {}
+	size_t GetTableSize(void) const { return 0; }
+};
+
+// Hardened 8 byte header: LastItem as 32 bit distance to the allocation and the size as 32 bit
+// Both halves are scrambled with a two round Feistel network keyed by a per allocator cookie and the header address,
+// so overwriting any byte garbles the whole record, which then fails the checks of the allocator on free
+// Allocations and the distance to the previous allocation are limited to 4 GiB
+class CompactMetaData
+{
+public:
+	static const bool SUPPORTS_FREE = true;
+	static const bool VERIFIES = true;
+	static const ptrdiff_t META_SIZE = 2 * sizeof(uint32_t);
+
+	CompactMetaData(void)
+		: mCookie(static_cast<uint32_t>(reinterpret_cast<uintptr_t>(this) >> 4)
+			^ static_cast<uint32_t>(std::chrono::steady_clock::now().time_since_epoch().count()) ^ 0x5BD1E995U)
+	{
+	}
+
+	bool Write(End side, uintptr_t alignedAddress, uintptr_t lastItem, size_t allocatedSize)
+	{
+		uintptr_t distance = side == End::Front ? alignedAddress - lastItem : lastItem - alignedAddress;
+		if (distance > UINT32_MAX || allocatedSize > UINT32_MAX)
+		{
+			return false;
+		}
+
+		uint32_t key = GetKey(alignedAddress);
+		uint32_t header[2] = { static_cast<uint32_t>(distance), static_cast<uint32_t>(allocatedSize) };
+		header[1] ^= Round(header[0], key);
+		header[0] ^= Round(header[1], key);
+		memcpy(reinterpret_cast<void*>(alignedAddress - META_SIZE), header, sizeof(header));
+		return true;
+	}
+
+	MetaRecord Read(End side, uintptr_t alignedAddress, size_t = 0) const
+	{
+		uint32_t key = GetKey(alignedAddress);
+		uint32_t header[2];
+		memcpy(header, reinterpret_cast<const void*>(alignedAddress - META_SIZE), sizeof(header));
+		header[0] ^= Round(header[1], key);
+		header[1] ^= Round(header[0], key);
+		return MetaRecord{ side == End::Front ? alignedAddress - header[0] : alignedAddress + header[0], header[1] };
+	}
+
+	void Pop(End) {}
+	void Clear(End) {}
+	size_t GetDepth(End) const { return 0; }
+	void FreeToDepth(End, size_t) {}
+	size_t GetTableSize(void) const { return 0; }
+
+private:
+	uint32_t GetKey(uintptr_t alignedAddress) const
+	{
+		return mCookie ^ static_cast<uint32_t>(alignedAddress) ^ static_cast<uint32_t>(static_cast<uint64_t>(alignedAddress) >> 32);
+	}
+
+	static uint32_t Round(uint32_t half, uint32_t key)
+	{
+		uint32_t mixed = (half ^ key) * 0x9E3779B1U;
+		return mixed ^ (mixed >> 15);
+	}
+
+	uint32_t mCookie;
+};
+
+// No header at all, allocations are a plain pointer bump
+struct NoMetaData
+{
+	static const bool SUPPORTS_FREE = false;
+	static const bool VERIFIES = false;
+	static const ptrdiff_t META_SIZE = 0;
+
+	bool Write(End, uintptr_t, uintptr_t, size_t) { return true; }
+	MetaRecord Read(End, uintptr_t, size_t = 0) const { return MetaRecord{ 0, 0 }; }
+	void Pop(End) {}
+	void Clear(End) {}
+	size_t GetDepth(End) const { return 0; }
+	void FreeToDepth(End, size_t) {}
+	size_t GetTableSize(void) const { return 0; }
+};
+
+// Header-less allocations which still support Free: the records live in one out-of-line stack per end
+// User allocations are packed densely and writing a record doesn't dirty the cache lines next to user data
+// Like CompactMetaData a record is 8 bytes, limiting allocations and the distance to the previous allocation to 4 GiB
+class SideTableMetaData
+{
+public:
+	static const bool SUPPORTS_FREE = true;
+	static const bool VERIFIES = false;
+	static const ptrdiff_t META_SIZE = 0;
+
+	SideTableMetaData(void) = default;
+
+	~SideTableMetaData(void)
+	{
+		free(mStacks[0].Records);
+		free(mStacks[1].Records);
+	}
+
+	bool Write(End side, uintptr_t alignedAddress, uintptr_t lastItem, size_t allocatedSize)
+	{
+		uintptr_t distance = side == End::Front ? alignedAddress - lastItem : lastItem - alignedAddress;
+		SideStack& stack = mStacks[static_cast<int>(side)];
+		if (distance > UINT32_MAX || allocatedSize > UINT32_MAX || (stack.Count == stack.Capacity && !Grow(stack)))
+		{
+			return false;
+		}
+		stack.Records[stack.Count++] = Record{ static_cast<uint32_t>(distance), static_cast<uint32_t>(allocatedSize) };
+		return true;
+	}
+
+	MetaRecord Read(End side, uintptr_t alignedAddress, size_t depth = 0) const
+	{
+		const SideStack& stack = mStacks[static_cast<int>(side)];
+		const Record& record = stack.Records[stack.Count - 1 - depth];
+		return MetaRecord{ side == End::Front ? alignedAddress - record.Distance : alignedAddress + record.Distance, record.Size };
+	}
+
+	void Pop(End side)
+	{
+		--mStacks[static_cast<int>(side)].Count;
+	}
+
+	void Clear(End side)
+	{
+		mStacks[static_cast<int>(side)].Count = 0;
+	}
+
+	size_t GetDepth(End side) const
+	{
+		return mStacks[static_cast<int>(side)].Count;
+	}
+
+	// Bytes of the records in use, they are not part of the stacks
+	size_t GetTableSize(void) const
+	{
+		return (mStacks[0].Count + mStacks[1].Count) * sizeof(Record);
+	}
+
+	void FreeToDepth(End side, size_t depth)
+	{
+		mStacks[static_cast<int>(side)].Count = depth;
+	}
+
+private:
+	SideTableMetaData(const SideTableMetaData&) = delete;
+	SideTableMetaData& operator = (const SideTableMetaData&) = delete;
+
+	// Distance from the allocation to the previous one and the size of the allocation
+	struct Record
+	{
+		uint32_t Distance;
+		uint32_t Size;
+	};
+
+	struct SideStack
+	{
+		Record* Records = nullptr;
+		size_t Count = 0;
+		size_t Capacity = 0;
+	};
+
+	static bool Grow(SideStack& stack)
+	{
+		size_t capacity = stack.Capacity ? stack.Capacity * 2 : INITIAL_CAPACITY;
+		Record* records = static_cast<Record*>(realloc(stack.Records, capacity * sizeof(Record)));
+		if (!records)
+		{
+			return false;
+		}
+		stack.Records = records;
+		stack.Capacity = capacity;
+		return true;
+	}
+
+	static const size_t INITIAL_CAPACITY = 64;
+
+	SideStack mStacks[2];
+};
+
+// Shrink policy for committed pages: once more than RetainBytes + HysteresisBytes are committed
+// but unused on one stack, everything except RetainBytes is decommitted again
+// The hysteresis prevents commit/decommit ping-pong when a stack oscillates around a page boundary
+struct DecommitPolicy
+{
+	size_t RetainBytes = 0;
+	size_t HysteresisBytes = SIZE_MAX; // Disabled by default -> pages are kept until destruction
+};
+
+// Memory used by each stack, e.g. the committed memory of a previous run to prewarm the next one
+struct CommitWatermark
+{
+	size_t FrontBytes = 0;
+	size_t BackBytes = 0;
+};
+
+// Options for growth policies which reserve virtual memory, ignored by fixed size policies
+struct VirtualMemoryOptions
+{
+	// Back the reservation with transparent huge pages and commit in huge page granules
+	// Falls back to normal pages if huge pages are not available
+	bool HugePages = false;
+
+	// Minimum amount of memory committed at once, rounded up to whole pages (0 = one page)
+	size_t CommitGranule = 0;
+
+	// Commit ahead by at least twice the last commit of the same stack, so a growing stack needs O(log n) commits
+	// Decommitting restarts the growth at the granule
+	bool GeometricCommit = false;
+
+	// Commits and faults in this much memory per stack during construction (see Prewarm)
+	// Also used by fixed size policies, where the memory is only faulted in
+	CommitWatermark Prewarm;
+	bool PrewarmAsync = false;
+
+	// Linux only: places the reservation and all commits on this NUMA node (see NumaArenas)
+	// NUMA_CURRENT_NODE places every commit on the node of the thread which commits it
+	// Without strict binding other nodes are used when the node runs out of memory and failed binds are ignored
+	static const int NUMA_NONE = -1;
+	static const int NUMA_CURRENT_NODE = -2;
+	int NumaNode = NUMA_NONE;
+	bool NumaStrict = false;
+};
+
+// Usage statistics of one allocator, LiveBytes/PeakBytes/AllocationCount/FreeCount are indexed by End
+// Live, committed, reserved and meta table sizes are always available, everything else needs the CollectStats policy
+// Requested, padding, canary and meta bytes are totals of all allocations since construction or ResetStats
+struct AllocatorStats
+{
+	size_t LiveBytes[2] = {}; // Used bytes of each stack including padding, canaries and meta data
+	size_t PeakBytes[2] = {};
+	size_t AllocationCount[2] = {};
+	size_t FreeCount[2] = {};
+	size_t RequestedBytes = 0;
+	size_t PaddingBytes = 0;
+	size_t CanaryBytes = 0;
+	size_t MetaBytes = 0;
+	size_t MetaTableBytes = 0; // Records in use which are kept outside of the stacks (SideTableMetaData)
+	size_t CommittedBytes = 0;
+	size_t CommitAheadBytes = 0;
+	size_t ReservedBytes = 0;
+	size_t CommitCount = 0;
+	size_t DecommitCount = 0;
+	size_t SpillCount = 0; // Allocations served by the fallback policy
+	size_t SpillBytes = 0;
+	size_t ChunkCount = 0; // Chunks chained by a segmented fallback right now
+};
+
+// Growth policies: where the memory comes from and whether it is committed lazily
+// Fixed size, the whole memory is requested with malloc during construction
+class MallocGrowth
+{
+public:
+	static const size_t DEFAULT_RESERVE_SIZE = 0; // Not used, malloc always uses ctor param max_size
+	static const size_t DEFAULT_SLICE_SIZE = 1024 * 1024; // Thread arenas malloc all slices at once, so they are kept small
+
+	bool Init(size_t maxSize, size_t, uintptr_t& begin, uintptr_t& end)
+	{
+		mMemory = malloc(maxSize);
+		if (!mMemory)
+		{
+			return false;
+		}
+
+		begin = reinterpret_cast<uintptr_t>(mMemory);
+		end = begin + maxSize;
+
+		HTL_DEBUG("constructed allocator from [%llx] to [%llx]", begin, end);
+		HTL_DEBUG("size: [%zu]", maxSize);
+		HTL_DEBUG("diff: [%llu]", end - begin);
+		return true;
+	}
+
+	// Uses a buffer owned by somebody else, which is not freed on release
+	bool InitExternal(void* memory, size_t size, uintptr_t& begin, uintptr_t& end)
+	{
+		begin = reinterpret_cast<uintptr_t>(memory);
+		end = begin + size;
+		return memory != nullptr;
+	}
+
+	void Release(void)
+	{
+		free(mMemory);
+		mMemory = nullptr;
+	}
+
+	// Memory shared by several allocators (see ThreadArenaRegistry), every allocator gets a slice of it
+	static void* ReserveShared(size_t size)
+	{
+		return malloc(size);
+	}
+
+	static void ReleaseShared(void* memory, size_t)
+	{
+		free(memory);
+	}
+
+	static size_t GetSliceGranularity(void)
+	{
+		return alignof(std::max_align_t);
+	}
+
+	void SetOptions(const VirtualMemoryOptions&) {}
+	bool UsesHugePages(void) const { return false; }
+
+	// The memory is always committed, it only has to be faulted in, which is always done synchronously
+	bool Prewarm(uintptr_t frontStart, uintptr_t frontEnd, uintptr_t backStart, uintptr_t backEnd, bool)
+	{
+		size_t pageSize = VirtualMemory::GetPageSize();
+		return VirtualMemory::Populate(reinterpret_cast<void*>(frontStart), frontEnd - frontStart, pageSize, true)
+			&& VirtualMemory::Populate(reinterpret_cast<void*>(backStart), backEnd - backStart, pageSize, true);
+	}
+
+	// Nothing is committed on demand
+	CommitWatermark GetCommitWatermark(uintptr_t, uintptr_t) const { return CommitWatermark(); }
+	void FillStats(AllocatorStats&) const {}
+
+	bool CommitFront(uintptr_t) { return true; }
+	bool CommitBack(uintptr_t) { return true; }
+	bool DecommitFront(uintptr_t, uintptr_t) { return true; }
+	bool DecommitBack(uintptr_t, uintptr_t) { return true; }
+
+	// Malloc memory can't be protected page by page
+	static const bool SUPPORTS_GUARD_PAGES = false;
+	size_t GetPageSize(void) const { return VirtualMemory::GetPageSize(); }
+	bool AddGuardPage(End, uintptr_t, uintptr_t) { return false; }
+	void ReleaseGuardPages(End, uintptr_t) {}
+	uintptr_t GetGuardEnd(End, uintptr_t) const { return 0; }
+	void SetDecommitPolicy(const DecommitPolicy&) {}
+
+	size_t GetCommittedSize(uintptr_t begin, uintptr_t end) const
+	{
+		return end - begin;
+	}
+
+private:
+	void* mMemory = nullptr;
+};
+
+// Reserves a big chunk of virtual memory and commits pages on demand, which allows both stacks to grow
+class VirtualMemoryGrowth
+{
+public:
+	static const size_t DEFAULT_ALLOC_SIZE = 1024 * 1024 * 1024; // Arbitrary maximum size of reserved virtual memory, for malloc using ctor param max_size
+	static const size_t DEFAULT_RESERVE_SIZE = DEFAULT_ALLOC_SIZE;
+	static const size_t DEFAULT_SLICE_SIZE = 64 * 1024 * 1024; // Only reserved, pages of thread arenas are committed on demand
+
+	// Growing allocator ignores max_size and reserves an internally specified size to allow resizing further inizial allocated size
+	bool Init(size_t maxSize, size_t realMaxSize, uintptr_t& begin, uintptr_t& end)
+	{
+		// Normally we would reserve a big chunk of virtual memory (defined as DEFAULT_ALLOC_SIZE) to allow internal grow
+		// but if the user requests more memory, we need to support it
+		if (maxSize > realMaxSize)
+		{
+			realMaxSize = maxSize;
+		}
+
+		// Reserve memory and init pointers
+		mPageSize = VirtualMemory::GetPageSize();
+		//HTL_DEBUG("page size: %zu bytes", mPageSize);
+
+		// With huge pages the whole reservation is huge page aligned and every commit covers whole huge pages
+		size_t hugePageSize = mOptions.HugePages ? VirtualMemory::GetHugePageSize() : 0;
+		if (hugePageSize > mPageSize)
+		{
+			size_t hugeSize = (realMaxSize + hugePageSize - 1) & ~(hugePageSize - 1);
+			mReserved = VirtualMemory::ReserveHugePages(hugeSize, hugePageSize);
+			if (mReserved)
+			{
+				realMaxSize = hugeSize;
+				mPageSize = hugePageSize;
+				mHugePages = true;
+			}
+		}
+
+		// First reserve memory from virtual space, pages stay inaccessible until they are commited
+		if (!mReserved)
+		{
+			mReserved = VirtualMemory::Reserve(realMaxSize);
+		}
+		if (!mReserved)
+		{
+			return false;
+		}
+		mReservedSize = realMaxSize;
+		mOwnsReservation = true;
+
+		// Binding the whole reservation once covers all later commits, pages keep the policy after decommits
+		// The current node is bound again by every commit, the initial one is the node of the constructing thread
+		if (mOptions.NumaNode != VirtualMemoryOptions::NUMA_NONE && !BindToNumaNode(mReserved, mReservedSize))
+		{
+			VirtualMemory::Release(mReserved, mReservedSize);
+			mReserved = nullptr;
+			return false;
+		}
+
+		HTL_DEBUG("Reserved virtual memory from [%llx] to [%llx] for size %zu", reinterpret_cast<uintptr_t>(mReserved), (reinterpret_cast<uintptr_t>(mReserved) + realMaxSize), realMaxSize);
+
+		return CommitInitialPages(begin, end);
+	}
+
+	// Uses an already reserved range owned by somebody else (e.g. a slice of a shared reservation)
+	// On release only the pages are decommitted, the range itself stays reserved
+	bool InitExternal(void* memory, size_t size, uintptr_t& begin, uintptr_t& end)
+	{
+		mPageSize = VirtualMemory::GetPageSize();
+		mReserved = memory;
+		mReservedSize = size;
+		mOwnsReservation = false;
+		return memory != nullptr && CommitInitialPages(begin, end);
+	}
+
+	void Release(void)
+	{
+		WaitForPrewarm();
+		free(mGuards[0].Pages);
+		free(mGuards[1].Pages);
+		mGuards[0] = mGuards[1] = GuardStack();
+		if (mReserved)
+		{
+			if (mOwnsReservation)
+			{
+				VirtualMemory::Release(mReserved, mReservedSize);
+			}
+			else
+			{
+				VirtualMemory::Decommit(mReserved, mReservedSize);
+			}
+			mReserved = nullptr;
+		}
+	}
+
+	static void* ReserveShared(size_t size)
+	{
+		return VirtualMemory::Reserve(size);
+	}
+
+	static void ReleaseShared(void* memory, size_t size)
+	{
+		VirtualMemory::Release(memory, size);
+	}
+
+	static size_t GetSliceGranularity(void)
+	{
+		return VirtualMemory::GetPageSize();
+	}
+
+	// Commit additional space if necessary, so that everything up to newTop is usable
+	bool CommitFront(uintptr_t newTop)
+	{
+		return newTop <= mPageEnd || CommitFrontPages(newTop);
+	}
+
+	bool CommitBack(uintptr_t newTop)
+	{
+		return newTop >= mPageStart || CommitBackPages(newTop);
+	}
+
+	// Applies the decommit policy after memory was released, the first and last page always stay committed
+	// Pages which are committed by both stacks (small reservations) are never decommitted by the other stack
+	// A running prewarm is joined first, it must not populate pages while they are decommitted or protected
+	bool DecommitFront(uintptr_t begin, uintptr_t usedEnd)
+	{
+		size_t unused = mPageEnd - usedEnd;
+		if (unused <= mDecommitPolicy.RetainBytes || unused - mDecommitPolicy.RetainBytes <= mDecommitPolicy.HysteresisBytes)
+		{
+			return true;
+		}
+
+		uintptr_t keepEnd = AlignUpToPage(usedEnd + mDecommitPolicy.RetainBytes);
+		if (keepEnd < begin + mPageSize)
+		{
+			keepEnd = begin + mPageSize;
+		}
+		uintptr_t decommitEnd = mPageEnd < mPageStart ? mPageEnd : mPageStart;
+		WaitForPrewarm();
+		if (keepEnd < decommitEnd && !VirtualMemory::Decommit(reinterpret_cast<void*>(keepEnd), decommitEnd - keepEnd))
+		{
+			return false;
+		}
+		if (keepEnd < mPageEnd)
+		{
+			mPageEnd = keepEnd;
+			mLastFrontCommit = 0;
+			++mDecommitCount;
+			HTL_DEBUG("Decommited Pages Front  [%llx]", mPageEnd);
+		}
+		return true;
+	}
+
+	bool DecommitBack(uintptr_t end, uintptr_t usedBegin)
+	{
+		size_t unused = usedBegin - mPageStart;
+		if (unused <= mDecommitPolicy.RetainBytes || unused - mDecommitPolicy.RetainBytes <= mDecommitPolicy.HysteresisBytes)
+		{
+			return true;
+		}
+
+		uintptr_t keepStart = (usedBegin - mDecommitPolicy.RetainBytes) & ~(mPageSize - 1);
+		if (keepStart > end - mPageSize)
+		{
+			keepStart = end - mPageSize;
+		}
+		uintptr_t decommitStart = mPageStart > mPageEnd ? mPageStart : mPageEnd;
+		WaitForPrewarm();
+		if (decommitStart < keepStart && !VirtualMemory::Decommit(reinterpret_cast<void*>(decommitStart), keepStart - decommitStart))
+		{
+			return false;
+		}
+		if (keepStart > mPageStart)
+		{
+			mPageStart = keepStart;
+			mLastBackCommit = 0;
+			++mDecommitCount;
+			HTL_DEBUG("Decommited Pages Back   [%llx]", mPageStart);
+		}
+		return true;
+	}
+
+	void SetDecommitPolicy(const DecommitPolicy& policy)
+	{
+		mDecommitPolicy = policy;
+	}
+
+	// Guard pages are committed pages inside a stack, made inaccessible as long as their allocation lives
+	static const bool SUPPORTS_GUARD_PAGES = true;
+
+	size_t GetPageSize(void) const
+	{
+		return mPageSize;
+	}
+
+	// Protects the committed page at page for the allocation at allocation, the records of a stack stay in LIFO order
+	bool AddGuardPage(End side, uintptr_t allocation, uintptr_t page)
+	{
+		GuardStack& stack = mGuards[static_cast<int>(side)];
+		if (stack.Count == stack.Capacity)
+		{
+			size_t capacity = stack.Capacity ? stack.Capacity * 2 : 64;
+			GuardPage* pages = static_cast<GuardPage*>(realloc(stack.Pages, capacity * sizeof(GuardPage)));
+			if (!pages)
+			{
+				return false;
+			}
+			stack.Pages = pages;
+			stack.Capacity = capacity;
+		}
+		WaitForPrewarm();
+		if (!VirtualMemory::Protect(reinterpret_cast<void*>(page), mPageSize, false))
+		{
+			return false;
+		}
+		stack.Pages[stack.Count++] = GuardPage{ allocation, page };
+		return true;
+	}
+
+	// Makes the guard pages of all allocations behind the last live one (top) accessible again
+	void ReleaseGuardPages(End side, uintptr_t top)
+	{
+		GuardStack& stack = mGuards[static_cast<int>(side)];
+		if (stack.Count > 0)
+		{
+			WaitForPrewarm();
+		}
+		while (stack.Count > 0)
+		{
+			const GuardPage& guard = stack.Pages[stack.Count - 1];
+			if (side == End::Front ? guard.Allocation <= top : guard.Allocation >= top)
+			{
+				break;
+			}
+			VirtualMemory::Protect(reinterpret_cast<void*>(guard.Page), mPageSize, true);
+			--stack.Count;
+		}
+	}
+
+	// End of the guard page which belongs to allocation, 0 if it has none
+	// Records of already freed allocations may still be on the stack, they are skipped
+	uintptr_t GetGuardEnd(End side, uintptr_t allocation) const
+	{
+		const GuardStack& stack = mGuards[static_cast<int>(side)];
+		for (size_t i = stack.Count; i > 0; --i)
+		{
+			const GuardPage& guard = stack.Pages[i - 1];
+			if (guard.Allocation == allocation)
+			{
+				return guard.Page + mPageSize;
+			}
+			if (side == End::Front ? guard.Allocation < allocation : guard.Allocation > allocation)
+			{
+				break;
+			}
+		}
+		return 0;
+	}
+
+	// Has to be set before Init, external memory always uses normal pages and no NUMA binding
+	void SetOptions(const VirtualMemoryOptions& options)
+	{
+		mOptions = options;
+	}
+
+	bool UsesHugePages(void) const
+	{
+		return mHugePages;
+	}
+
+	// Commits everything up to frontEnd and from backStart and faults in [frontStart, frontEnd) and [backStart, backEnd)
+	// The ranges only cover free memory, guard pages of live allocations are never inside of them
+	// Async faulting needs MADV_POPULATE_WRITE and is skipped without it, because touching would race with the user
+	bool Prewarm(uintptr_t frontStart, uintptr_t frontEnd, uintptr_t backStart, uintptr_t backEnd, bool async)
+	{
+		if (!CommitFront(frontEnd) || !CommitBack(backStart))
+		{
+			return false;
+		}
+
+		WaitForPrewarm();
+		uintptr_t frontPage = frontStart & ~(mPageSize - 1);
+		void* front = reinterpret_cast<void*>(frontPage);
+		size_t frontSize = frontEnd > frontStart ? frontEnd - frontPage : 0;
+		uintptr_t backPage = backStart & ~(mPageSize - 1);
+		void* back = reinterpret_cast<void*>(backPage);
+		size_t backSize = backEnd > backStart ? backEnd - backPage : 0;
+		size_t pageSize = mPageSize;
+		if (async)
+		{
+			mPrewarmThread = std::thread([front, frontSize, back, backSize, pageSize]()
+			{
+				VirtualMemory::Populate(front, frontSize, pageSize, false);
+				VirtualMemory::Populate(back, backSize, pageSize, false);
+			});
+			return true;
+		}
+		return VirtualMemory::Populate(front, frontSize, pageSize, true)
+			&& VirtualMemory::Populate(back, backSize, pageSize, true);
+	}
+
+	void FillStats(AllocatorStats& stats) const
+	{
+		stats.CommitCount = mCommitCount;
+		stats.DecommitCount = mDecommitCount;
+	}
+
+	// Highest amount of memory each stack had committed so far
+	CommitWatermark GetCommitWatermark(uintptr_t begin, uintptr_t end) const
+	{
+		CommitWatermark watermark;
+		watermark.FrontBytes = mHighestPageEnd - begin;
+		watermark.BackBytes = end - mLowestPageStart;
+		return watermark;
+	}
+
+	// Committed memory of both stacks, pages shared by front and back are only counted once
+	size_t GetCommittedSize(uintptr_t begin, uintptr_t end) const
+	{
+		if (mPageEnd >= mPageStart)
+		{
+			return end - begin;
+		}
+		return (mPageEnd - begin) + (end - mPageStart);
+	}
+
+private:
+	uintptr_t AlignUpToPage(uintptr_t address) const
+	{
+		return (address + mPageSize - 1) & ~(mPageSize - 1);
+	}
+
+	// Commit a page of space for front and back
+	bool CommitInitialPages(uintptr_t& begin, uintptr_t& end)
+	{
+		mCommitGranule = mOptions.CommitGranule > mPageSize ? AlignUpToPage(mOptions.CommitGranule) : mPageSize;
+
+		void* page = VirtualMemory::Commit(mReserved, mPageSize, mPageSize);
+		if (!page)
+		{
+			Release();
+			return false;
+		}
+		begin = reinterpret_cast<uintptr_t>(page);
+		mPageEnd = begin + mPageSize;
+
+		HTL_DEBUG("mPageEnd   [%llx]", mPageEnd);
+
+		page = VirtualMemory::Commit(reinterpret_cast<void*>(begin + mReservedSize - mPageSize), mPageSize, mPageSize);
+		if (!page)
+		{
+			Release();
+			return false;
+		}
+		mPageStart = reinterpret_cast<uintptr_t>(page);
+		end = mPageStart + mPageSize;
+		mHighestPageEnd = mPageEnd;
+		mLowestPageStart = mPageStart;
+
+		HTL_DEBUG("mPageStart [%llx]", mPageStart);
+		return true;
+	}
+
+	// One commit covers the whole shortfall rounded up to the granule (or the geometric size)
+	// Only the part which is really needed may overlap pages already committed by the other stack
+	bool CommitFrontPages(uintptr_t newTop)
+	{
+		size_t needed = AlignUpToPage(newTop) - mPageEnd;
+		size_t size = GetCommitSize(needed, mLastFrontCommit);
+		uintptr_t limit = mPageStart > mPageEnd ? mPageStart : AlignUpToPage(reinterpret_cast<uintptr_t>(mReserved) + mReservedSize);
+		if (size > limit - mPageEnd)
+		{
+			size = needed > limit - mPageEnd ? needed : limit - mPageEnd;
+		}
+
+		if (!VirtualMemory::Commit(reinterpret_cast<void*>(mPageEnd), size, mPageSize)
+			|| (mOptions.NumaNode == VirtualMemoryOptions::NUMA_CURRENT_NODE && !BindToNumaNode(reinterpret_cast<void*>(mPageEnd), size)))
+		{
+			return false;
+		}
+		mPageEnd += size;
+		mLastFrontCommit = size;
+		++mCommitCount;
+		if (mPageEnd > mHighestPageEnd)
+		{
+			mHighestPageEnd = mPageEnd;
+		}
+
+		HTL_DEBUG("Commited new Pages Front  [%llx]", mPageEnd);
+		return true;
+	}
+
+	bool CommitBackPages(uintptr_t newTop)
+	{
+		size_t needed = mPageStart - (newTop & ~(mPageSize - 1));
+		size_t size = GetCommitSize(needed, mLastBackCommit);
+		uintptr_t limit = mPageEnd < mPageStart ? mPageEnd : reinterpret_cast<uintptr_t>(mReserved);
+		if (size > mPageStart - limit)
+		{
+			size = needed > mPageStart - limit ? needed : mPageStart - limit;
+		}
+
+		if (!VirtualMemory::Commit(reinterpret_cast<void*>(mPageStart - size), size, mPageSize)
+			|| (mOptions.NumaNode == VirtualMemoryOptions::NUMA_CURRENT_NODE && !BindToNumaNode(reinterpret_cast<void*>(mPageStart - size), size)))
+		{
+			return false;
+		}
+		mPageStart -= size;
+		mLastBackCommit = size;
+		++mCommitCount;
+		if (mPageStart < mLowestPageStart)
+		{
+			mLowestPageStart = mPageStart;
+		}
+
+		HTL_DEBUG("Commited new Pages Back   [%llx]", mPageStart);
+		return true;
+	}
+
+	// Only strict binding reports failures, otherwise the memory is just placed wherever the kernel wants
+	bool BindToNumaNode(void* address, size_t size) const
+	{
+		int node = mOptions.NumaNode == VirtualMemoryOptions::NUMA_CURRENT_NODE ? VirtualMemory::GetCurrentNumaNode() : mOptions.NumaNode;
+		return VirtualMemory::BindToNumaNode(address, size, node, mOptions.NumaStrict) || !mOptions.NumaStrict;
+	}
+
+	void WaitForPrewarm(void)
+	{
+		if (mPrewarmThread.joinable())
+		{
+			mPrewarmThread.join();
+		}
+	}
+
+	size_t GetCommitSize(size_t needed, size_t lastCommit) const
+	{
+		size_t size = (needed + mCommitGranule - 1) / mCommitGranule * mCommitGranule;
+		if (mOptions.GeometricCommit && size < 2 * lastCommit)
+		{
+			size = 2 * lastCommit;
+		}
+		return size;
+	}
+
+	void* mReserved = nullptr;
+	size_t mReservedSize = 0; // Size of the whole reservation, needed for releasing it again
+	bool mOwnsReservation = false;
+	size_t mPageSize = 0; // Size of commitable pages in virtual memory, the huge page size if huge pages are used
+	bool mHugePages = false;
+	VirtualMemoryOptions mOptions;
+	size_t mCommitGranule = 0; // Multiple of mPageSize
+	size_t mLastFrontCommit = 0; // Sizes of the last commits for geometric growth
+	size_t mLastBackCommit = 0;
+	uintptr_t mHighestPageEnd = 0; // Watermarks of the committed pages
+	uintptr_t mLowestPageStart = 0;
+	std::thread mPrewarmThread;
+	size_t mCommitCount = 0; // Commits and decommits after construction
+	size_t mDecommitCount = 0;
+
+	uintptr_t mPageEnd = 0; // End of committed pages for front
+	uintptr_t mPageStart = 0; // Begin of commited pages for back
+
+	struct GuardPage
+	{
+		uintptr_t Allocation;
+		uintptr_t Page;
+	};
+
+	struct GuardStack
+	{
+		GuardPage* Pages = nullptr;
+		size_t Count = 0;
+		size_t Capacity = 0;
+	};
+
+	GuardStack mGuards[2]; // Indexed by End
+
+	DecommitPolicy mDecommitPolicy;
+};
+
+// Typed error of a failed call, passed to the error policy and returned by TryAllocate
+enum class AllocatorError : uint8_t
+{
+	None,
+	ConstructionFailed, // Not enough memory or invalid external memory, the ctor throws bad_alloc afterwards
+	InvalidSize,
+	InvalidAlignment,
+	Overlap, // Front and back stack would overlap -> the allocator is full
+	CommitFailed,
+	DecommitFailed,
+	MetaDataFailed,
+	InvalidPointer,
+	NotLastAllocation, // Violates the LIFO order
+	CorruptedCanary,
+	CorruptedMetaData, // Header of an allocation doesn't fit to the stack, only detected by verifying meta data policies
+	Unsupported // Not supported by the selected policies, e.g. Free without meta data
+};
+
+inline const char* GetErrorName(AllocatorError error)
+{
+	switch (error)
+	{
+	case AllocatorError::None: return "None";
+	case AllocatorError::ConstructionFailed: return "ConstructionFailed";
+	case AllocatorError::InvalidSize: return "InvalidSize";
+	case AllocatorError::InvalidAlignment: return "InvalidAlignment";
+	case AllocatorError::Overlap: return "Overlap";
+	case AllocatorError::CommitFailed: return "CommitFailed";
+	case AllocatorError::DecommitFailed: return "DecommitFailed";
+	case AllocatorError::MetaDataFailed: return "MetaDataFailed";
+	case AllocatorError::InvalidPointer: return "InvalidPointer";
+	case AllocatorError::NotLastAllocation: return "NotLastAllocation";
+	case AllocatorError::CorruptedCanary: return "CorruptedCanary";
+	case AllocatorError::CorruptedMetaData: return "CorruptedMetaData";
+	case AllocatorError::Unsupported: return "Unsupported";
+	}
+	return "Unknown";
+}
+
+// Result of TryAllocate, Memory is nullptr if Error is set
+struct AllocationResult
+{
+	void* Memory;
+	AllocatorError Error;
+
+	explicit operator bool(void) const
+	{
+		return Memory != nullptr;
+	}
+};
+
+// Error policies: Report is used for failures which are handled afterwards (e.g. construction throws bad_alloc),
+// Assert for invalid usage and out of memory situations, where the allocator returns nullptr / ignores the call
+// Everything except IgnoreErrors is cold and never inlined into the allocator
+struct IgnoreErrors
+{
+	static void Report(AllocatorError, const char*) {}
+	static void Assert(AllocatorError, const char*) {}
+};
+
+struct PrintErrors
+{
+	HTL_COLD static void Report(AllocatorError, const char* message)
+	{
+		printf(ANSI_COLOR_RED "[Error]" ANSI_COLOR_RESET ": %s\n", message);
+	}
+
+	HTL_COLD static void Assert(AllocatorError error, const char* message)
+	{
+		Report(error, message);
+	}
+};
+
+// In debug mode -> just use standard assert
+struct AssertErrors
+{
+	HTL_COLD static void Report(AllocatorError error, const char* message)
+	{
+		PrintErrors::Report(error, message);
+	}
+
+	HTL_COLD static void Assert(AllocatorError error, const char* message)
+	{
+		PrintErrors::Report(error, message);
+		assert(false);
+	}
+};
+
+// Forwards all errors to a handler which can be installed at runtime, e.g. to route them into the application's log
+// The handler is shared by all allocators using this policy and prints like PrintErrors until another one is set
+using ErrorHandler = void (*)(AllocatorError error, const char* message);
+
+struct HandlerErrors
+{
+	// nullptr restores the default handler
+	static void SetHandler(ErrorHandler handler)
+	{
+		GetHandler().store(handler ? handler : &PrintErrors::Report, std::memory_order_relaxed);
+	}
+
+	HTL_COLD static void Report(AllocatorError error, const char* message)
+	{
+		GetHandler().load(std::memory_order_relaxed)(error, message);
+	}
+
+	HTL_COLD static void Assert(AllocatorError error, const char* message)
+	{
+		Report(error, message);
+	}
+
+private:
+	static std::atomic<ErrorHandler>& GetHandler(void)
+	{
+		static std::atomic<ErrorHandler> handler{ &PrintErrors::Report };
+		return handler;
+	}
+};
+
+/**
+* Registry for per-thread allocator instances. One reservation is shared by all threads and every thread
+* lazily gets its own allocator on a slice of it, so allocating never needs a lock.
+* Only creating/destroying the instance of a thread and ResetAll() take the lock.
+**/
+template<class Allocator>
+class ThreadArenaRegistry
+{
+public:
+	static const size_t DEFAULT_SLICE_SIZE = Allocator::Growth::DEFAULT_SLICE_SIZE;
+	static const size_t DEFAULT_MAX_THREADS = 64;
+
+	static ThreadArenaRegistry& Get(void)
+	{
+		static ThreadArenaRegistry registry;
+		return registry;
+	}
+
+	// Has to be called before the first thread requests its allocator, returns false otherwise
+	bool Configure(size_t sliceSize, size_t maxThreads)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		if (mShared || sliceSize == 0 || maxThreads == 0)
+		{
+			return false;
+		}
+		mSliceSize = sliceSize;
+		mMaxThreads = maxThreads;
+		return true;
+	}
+
+	// Creates the instance of the calling thread on first use, throws bad_alloc if all slices are taken
+	// The instance is destroyed and its slice reused when the thread exits
+	Allocator& ThisThread(void)
+	{
+		thread_local ThreadSlot slot;
+		if (!slot.Instance)
+		{
+			slot.Instance = Acquire(slot.Index);
+			slot.Registry = this;
+		}
+		return *slot.Instance;
+	}
+
+	// Resets the allocators of all threads, only allowed while no thread allocates (e.g. at frame boundaries)
+	void ResetAll(void)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		for (size_t i = 0; mInstances && i < mMaxThreads; ++i)
+		{
+			if (mInstances[i])
+			{
+				mInstances[i]->Reset();
+			}
+		}
+	}
+
+private:
+	struct ThreadSlot
+	{
+		~ThreadSlot(void)
+		{
+			if (Instance)
+			{
+				Registry->Release(Index);
+			}
+		}
+
+		Allocator* Instance = nullptr;
+		ThreadArenaRegistry* Registry = nullptr;
+		size_t Index = 0;
+	};
+
+	ThreadArenaRegistry(void) = default;
+	ThreadArenaRegistry(const ThreadArenaRegistry&) = delete;
+	ThreadArenaRegistry& operator = (const ThreadArenaRegistry&) = delete;
+
+	~ThreadArenaRegistry(void)
+	{
+		for (size_t i = 0; mInstances && i < mMaxThreads; ++i)
+		{
+			delete mInstances[i];
+		}
+		delete[] mInstances;
+		if (mShared)
+		{
+			Allocator::Growth::ReleaseShared(mShared, mSliceSize * mMaxThreads);
+		}
+	}
+
+	Allocator* Acquire(size_t& index)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		if (!mShared)
+		{
+			// Slices have to start at page boundaries, otherwise committing one slice would touch its neighbour
+			const size_t granularity = Allocator::Growth::GetSliceGranularity();
+			mSliceSize = (mSliceSize + granularity - 1) & ~(granularity - 1);
+			if (mSliceSize == 0 || mMaxThreads > SIZE_MAX / mSliceSize)
+			{
+				throw std::bad_alloc();
+			}
+			mShared = Allocator::Growth::ReserveShared(mSliceSize * mMaxThreads);
+			if (!mShared)
+			{
+				throw std::bad_alloc();
+			}
+			mInstances = new Allocator*[mMaxThreads]();
+		}
+
+		for (index = 0; index < mMaxThreads; ++index)
+		{
+			if (!mInstances[index])
+			{
+				void* slice = static_cast<char*>(mShared) + index * mSliceSize;
+				mInstances[index] = new Allocator(slice, mSliceSize);
+				return mInstances[index];
+			}
+		}
+		throw std::bad_alloc();
+	}
+
+	void Release(size_t index)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		delete mInstances[index];
+		mInstances[index] = nullptr;
+	}
+
+	std::mutex mMutex;
+	void* mShared = nullptr;
+	size_t mSliceSize = DEFAULT_SLICE_SIZE;
+	size_t mMaxThreads = DEFAULT_MAX_THREADS;
+	Allocator** mInstances = nullptr;
+};
+
+/**
+* One allocator instance per NUMA node, each with its reservation and commits bound to its node.
+* Threads pinned to a socket use the instance of their node, so their memory never crosses the interconnect.
+* Without NUMA support (or on a single node) there is exactly one instance. Needs a VirtualMemoryGrowth allocator.
+**/
+template<class Allocator>
+class NumaArenas
+{
+public:
+	// Throws bad_alloc if one of the instances can't be constructed, options.NumaNode is overwritten per instance
+	NumaArenas(size_t maxSize, VirtualMemoryOptions options = VirtualMemoryOptions(), size_t realMaxSize = Allocator::Growth::DEFAULT_RESERVE_SIZE)
+		: mNodeCount(static_cast<size_t>(VirtualMemory::GetNumaNodeCount()))
+	{
+		mInstances = new Allocator*[mNodeCount]();
+		try
+		{
+			for (size_t node = 0; node < mNodeCount; ++node)
+			{
+				options.NumaNode = static_cast<int>(node);
+				mInstances[node] = new Allocator(maxSize, options, realMaxSize);
+			}
+		}
+		catch (...)
+		{
+			Destroy();
+			throw;
+		}
+	}
+
+	~NumaArenas(void)
+	{
+		Destroy();
+	}
+
+	NumaArenas(const NumaArenas&) = delete;
+	NumaArenas& operator = (const NumaArenas&) = delete;
+
+	size_t GetNodeCount(void) const
+	{
+		return mNodeCount;
+	}
+
+	// Unknown nodes (e.g. hot plugged ones) map to node 0
+	Allocator& ForNode(int node)
+	{
+		return *mInstances[node >= 0 && static_cast<size_t>(node) < mNodeCount ? node : 0];
+	}
+
+	// The instance of the node the calling thread runs on right now, the thread should be pinned to its socket
+	Allocator& ThisNode(void)
+	{
+		return ForNode(VirtualMemory::GetCurrentNumaNode());
+	}
+
+	// Same as ThreadArenaRegistry::ResetAll, only allowed while no thread allocates
+	void ResetAll(void)
+	{
+		for (size_t node = 0; node < mNodeCount; ++node)
+		{
+			mInstances[node]->Reset();
+		}
+	}
+
+private:
+	void Destroy(void)
+	{
+		for (size_t node = 0; mInstances && node < mNodeCount; ++node)
+		{
+			delete mInstances[node];
+		}
+		delete[] mInstances;
+		mInstances = nullptr;
+	}
+
+	size_t mNodeCount = 1;
+	Allocator** mInstances = nullptr;
+};
+
+// Stats policies: counters which cost time per allocation are only collected if selected at compile time
+struct NoStats
+{
+	static const bool ENABLED = false;
+
+	void OnAllocate(End, size_t, size_t, size_t, size_t, size_t) {}
+	void OnResize(End, size_t) {}
+	void OnFree(End) {}
+	void Fill(AllocatorStats&) const {}
+};
+
+class CollectStats
+{
+public:
+	static const bool ENABLED = true;
+
+	void OnAllocate(End side, size_t requested, size_t padding, size_t canaries, size_t meta, size_t used)
+	{
+		int index = static_cast<int>(side);
+		++mStats.AllocationCount[index];
+		mStats.RequestedBytes += requested;
+		mStats.PaddingBytes += padding;
+		mStats.CanaryBytes += canaries;
+		mStats.MetaBytes += meta;
+		OnResize(side, used);
+	}
+
+	void OnResize(End side, size_t used)
+	{
+		size_t& peak = mStats.PeakBytes[static_cast<int>(side)];
+		if (used > peak)
+		{
+			peak = used;
+		}
+	}
+
+	void OnFree(End side)
+	{
+		++mStats.FreeCount[static_cast<int>(side)];
+	}
+
+	void Fill(AllocatorStats& stats) const
+	{
+		stats = mStats;
+	}
+
+private:
+	AllocatorStats mStats;
+};
+
+// Trace policies: record the allocation stream, e.g. to replay it offline with the TraceReplay tool
+enum class TraceOp : uint8_t
+{
+	Allocate,
+	Reallocate,
+	Free,
+	Reset
+};
+
+// Binary record of one operation, trace files are a plain sequence of these
+// Free and Reset don't need a size, because they always refer to the top or the whole stack
+struct TraceEvent
+{
+	uint64_t Timestamp; // Nanoseconds of steady_clock
+	uint64_t Size;
+	uint32_t Alignment;
+	uint8_t Op; // TraceOp
+	uint8_t Side; // End
+	uint16_t Reserved;
+};
+static_assert(sizeof(TraceEvent) == 24, "Trace files depend on the layout of TraceEvent");
+
+struct NoTrace
+{
+	static const bool ENABLED = false;
+
+	void Record(TraceOp, End, size_t, size_t) {}
+};
+
+// Single producer / single consumer ring buffer, the allocator writes and any one other thread may drain it
+// Nothing blocks: if the consumer falls behind, new events are dropped and counted
+class RingBufferTrace
+{
+public:
+	static const bool ENABLED = true;
+	static const size_t CAPACITY = 1 << 16; // Power of 2, 1.5 MiB of events
+
+	RingBufferTrace(void)
+		: mEvents(static_cast<TraceEvent*>(malloc(CAPACITY * sizeof(TraceEvent))))
+	{
+	}
+
+	~RingBufferTrace(void)
+	{
+		free(mEvents);
+	}
+
+	void Record(TraceOp op, End side, size_t size, size_t alignment)
+	{
+		uint64_t head = mHead.load(std::memory_order_relaxed);
+		if (!mEvents || head - mTail.load(std::memory_order_acquire) == CAPACITY)
+		{
+			mDropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+
+		uint64_t timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+		mEvents[head & (CAPACITY - 1)] = TraceEvent{ timestamp, size, static_cast<uint32_t>(alignment), static_cast<uint8_t>(op), static_cast<uint8_t>(side), 0 };
+		mHead.store(head + 1, std::memory_order_release);
+	}
+
+	// Moves up to maxCount of the oldest events to out and returns how many were moved
+	size_t Drain(TraceEvent* out, size_t maxCount)
+	{
+		uint64_t tail = mTail.load(std::memory_order_relaxed);
+		uint64_t available = mHead.load(std::memory_order_acquire) - tail;
+		size_t count = available < maxCount ? static_cast<size_t>(available) : maxCount;
+		for (size_t i = 0; i < count; ++i)
+		{
+			out[i] = mEvents[(tail + i) & (CAPACITY - 1)];
+		}
+		mTail.store(tail + count, std::memory_order_release);
+		return count;
+	}
+
+	// Drains all recorded events into a trace file
+	bool WriteTo(FILE* file)
+	{
+		TraceEvent chunk[256];
+		size_t count = 0;
+		while ((count = Drain(chunk, 256)) > 0)
+		{
+			if (fwrite(chunk, sizeof(TraceEvent), count, file) != count)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	size_t GetDropped(void) const
+	{
+		return mDropped.load(std::memory_order_relaxed);
+	}
+
+private:
+	RingBufferTrace(const RingBufferTrace&) = delete;
+	RingBufferTrace& operator = (const RingBufferTrace&) = delete;
+
+	TraceEvent* mEvents;
+	std::atomic<uint64_t> mHead{ 0 }; // Next event to write, only changed by the allocator
+	std::atomic<uint64_t> mTail{ 0 }; // Next event to drain, only changed by the consumer
+	std::atomic<size_t> mDropped{ 0 };
+};
+
+// Fallback policies: where allocations go if both stacks meet (or committing fails) instead of returning a nullptr
+// Spilled allocations are freed LIFO like any other, or all at once with the next Reset of their stack
+// Markers also remember the position of the fallback, so FreeToMarker and ScopedFrame release later spills too
+struct NoFallback
+{
+	static const bool ENABLED = false;
+
+	struct Position {};
+
+	void* Allocate(End, size_t, size_t) { return nullptr; }
+	bool Reallocate(End, void*, size_t, size_t, void*&) { return false; }
+	bool IsSpilling(End) const { return false; }
+	bool IsLast(End, const void*) const { return false; }
+	bool Free(End, void*) { return false; }
+	Position GetPosition(End) const { return Position(); }
+	void FreeToPosition(End, const Position&) {}
+	void Reset(End) {}
+	void ResetStats(void) {}
+	void FillStats(AllocatorStats&) const {}
+};
+
+// Every spill is a separate malloc, kept in one intrusive list per stack
+// Spills and stack allocations may interleave, each of them is freed by its own pointer
+class HeapFallback
+{
+public:
+	static const bool ENABLED = true;
+
+	// Number of spills of the stack when a marker was taken
+	struct Position
+	{
+		size_t Depth;
+	};
+
+	HeapFallback(void) = default;
+
+	~HeapFallback(void)
+	{
+		Reset(End::Front);
+		Reset(End::Back);
+	}
+
+	void* Allocate(End side, size_t size, size_t alignment)
+	{
+		if (size > SIZE_MAX - sizeof(Block) - alignment)
+		{
+			return nullptr;
+		}
+
+		void* raw = malloc(sizeof(Block) + alignment - 1 + size);
+		if (!raw)
+		{
+			return nullptr;
+		}
+
+		Block*& top = mTops[static_cast<int>(side)];
+		uintptr_t memory = (reinterpret_cast<uintptr_t>(raw) + sizeof(Block) + alignment - 1) & ~(alignment - 1);
+		top = new (raw) Block{ top, reinterpret_cast<void*>(memory), size };
+		++mDepths[static_cast<int>(side)];
+		++mSpillCount;
+		mSpillBytes += size;
+		return top->Memory;
+	}
+
+	// Only the last spill of a stack is resized, returns false if memory is none of ours
+	bool Reallocate(End side, void* memory, size_t newSize, size_t alignment, void*& newMemory)
+	{
+		Block* old = mTops[static_cast<int>(side)];
+		if (!old || old->Memory != memory)
+		{
+			return false;
+		}
+
+		newMemory = Allocate(side, newSize, alignment);
+		if (newMemory)
+		{
+			memcpy(newMemory, memory, newSize < old->Size ? newSize : old->Size);
+			mTops[static_cast<int>(side)]->Previous = old->Previous;
+			--mDepths[static_cast<int>(side)];
+			free(old);
+		}
+		return true;
+	}
+
+	bool IsSpilling(End) const
+	{
+		return false;
+	}
+
+	// True if memory is the last spill of the stack, so Free would release it
+	bool IsLast(End side, const void* memory) const
+	{
+		const Block* top = mTops[static_cast<int>(side)];
+		return top && top->Memory == memory;
+	}
+
+	bool Free(End side, void* memory)
+	{
+		Block*& top = mTops[static_cast<int>(side)];
+		if (!top || top->Memory != memory)
+		{
+			return false;
+		}
+
+		Pop(side);
+		return true;
+	}
+
+	Position GetPosition(End side) const
+	{
+		return Position{ mDepths[static_cast<int>(side)] };
+	}
+
+	// Frees the spills made after the position was taken
+	void FreeToPosition(End side, const Position& position)
+	{
+		while (mDepths[static_cast<int>(side)] > position.Depth)
+		{
+			Pop(side);
+		}
+	}
+
+	void Reset(End side)
+	{
+		FreeToPosition(side, Position{ 0 });
+	}
+
+	void ResetStats(void)
+	{
+		mSpillCount = mSpillBytes = 0;
+	}
+
+	void FillStats(AllocatorStats& stats) const
+	{
+		stats.SpillCount = mSpillCount;
+		stats.SpillBytes = mSpillBytes;
+	}
+
+private:
+	HeapFallback(const HeapFallback&) = delete;
+	HeapFallback& operator = (const HeapFallback&) = delete;
+
+	// Sits at the start of each malloc, the user memory follows aligned
+	struct Block
+	{
+		Block* Previous;
+		void* Memory;
+		size_t Size;
+	};
+
+	void Pop(End side)
+	{
+		Block*& top = mTops[static_cast<int>(side)];
+		Block* previous = top->Previous;
+		free(top);
+		top = previous;
+		--mDepths[static_cast<int>(side)];
+	}
+
+	Block* mTops[2] = {};
+	size_t mDepths[2] = {};
+	size_t mSpillCount = 0;
+	size_t mSpillBytes = 0;
+};
+
+// Segmented growth: spills into a chain of further memory chunks per stack, a new chunk is reserved whenever
+// the newest one is full, so a small initial reservation still absorbs rare huge workloads
+// While a stack has chunks all its allocations go to the newest chunk, so the stack and its chunks stay in LIFO order
+// Chunks are plain bump regions of the growth policy, every allocation only has a header to unwind it (no canaries)
+// Chunks are unwound as soon as they are empty again, one empty chunk per stack is kept for the next spill
+// Chunks have at least the chunk size, larger allocations get a chunk of their own
+template<class Growth>
+class ChainedFallback
+{
+public:
+	static const bool ENABLED = true;
+	static const size_t DEFAULT_CHUNK_SIZE = 16 * 1024 * 1024;
+
+	// Length of the chain and state of the newest chunk when a marker was taken
+	struct Position
+	{
+		size_t Depth;
+		uintptr_t Top;
+		uintptr_t Last;
+	};
+
+	ChainedFallback(void) = default;
+
+	~ChainedFallback(void)
+	{
+		for (int i = 0; i < 2; ++i)
+		{
+			Reset(static_cast<End>(i));
+			delete mSpares[i];
+		}
+	}
+
+	// Only affects chunks reserved afterwards
+	void SetChunkSize(size_t chunkSize)
+	{
+		mChunkSize = chunkSize;
+	}
+
+	void* Allocate(End side, size_t size, size_t alignment)
+	{
+		Chunk* top = mTops[static_cast<int>(side)];
+		void* memory = top ? AllocateIn(top, size, alignment) : nullptr;
+		if (!memory && PushChunk(side, size, alignment))
+		{
+			memory = AllocateIn(mTops[static_cast<int>(side)], size, alignment);
+			if (!memory)
+			{
+				PopChunk(side);
+			}
+		}
+		if (memory)
+		{
+			++mSpillCount;
+			mSpillBytes += size;
+		}
+		return memory;
+	}
+
+	// The last allocation grows or shrinks in place if it still fits, otherwise it is copied on top of the chain
+	bool Reallocate(End side, void* memory, size_t newSize, size_t alignment, void*& newMemory)
+	{
+		Chunk* top = mTops[static_cast<int>(side)];
+		uintptr_t address = reinterpret_cast<uintptr_t>(memory);
+		if (!top || top->Last != address)
+		{
+			return false;
+		}
+
+		if (address % alignment == 0 && newSize <= top->Limit - address && top->Memory.CommitFront(address + newSize))
+		{
+			top->Top = address + newSize;
+			newMemory = memory;
+			return true;
+		}
+		size_t oldSize = top->Top - address;
+		newMemory = Allocate(side, newSize, alignment);
+		if (newMemory)
+		{
+			memcpy(newMemory, memory, newSize < oldSize ? newSize : oldSize);
+		}
+		return true;
+	}
+
+	bool IsSpilling(End side) const
+	{
+		return mTops[static_cast<int>(side)] != nullptr;
+	}
+
+	bool IsLast(End side, const void* memory) const
+	{
+		const Chunk* top = mTops[static_cast<int>(side)];
+		return top && top->Last == reinterpret_cast<uintptr_t>(memory);
+	}
+
+	bool Free(End side, void* memory)
+	{
+		if (!IsLast(side, memory))
+		{
+			return false;
+		}
+
+		Chunk* top = mTops[static_cast<int>(side)];
+		const Header* header = reinterpret_cast<const Header*>(top->Last - sizeof(Header));
+		top->Top = header->PreviousTop;
+		top->Last = header->PreviousLast;
+		if (!top->Last)
+		{
+			PopChunk(side);
+		}
+		return true;
+	}
+
+	Position GetPosition(End side) const
+	{
+		const Chunk* top = mTops[static_cast<int>(side)];
+		return top ? Position{ mDepths[static_cast<int>(side)], top->Top, top->Last } : Position{ 0, 0, 0 };
+	}
+
+	// Unwinds the chunks which were pushed after the position was taken and the newest chunk back to the position
+	// A position inside a chunk which was released in the meantime is ignored
+	void FreeToPosition(End side, const Position& position)
+	{
+		while (mDepths[static_cast<int>(side)] > position.Depth)
+		{
+			PopChunk(side);
+		}
+
+		Chunk* top = mTops[static_cast<int>(side)];
+		if (top && position.Depth > 0 && position.Top >= top->Begin && position.Top <= top->Top)
+		{
+			top->Top = position.Top;
+			top->Last = position.Last;
+			if (!top->Last)
+			{
+				PopChunk(side);
+			}
+		}
+	}
+
+	void Reset(End side)
+	{
+		while (mTops[static_cast<int>(side)])
+		{
+			PopChunk(side);
+		}
+	}
+
+	void ResetStats(void)
+	{
+		mSpillCount = mSpillBytes = 0;
+	}
+
+	void FillStats(AllocatorStats& stats) const
+	{
+		stats.SpillCount = mSpillCount;
+		stats.SpillBytes = mSpillBytes;
+		stats.ChunkCount = mChunkCount;
+	}
+
+private:
+	ChainedFallback(const ChainedFallback&) = delete;
+	ChainedFallback& operator = (const ChainedFallback&) = delete;
+
+	struct Chunk
+	{
+		~Chunk(void)
+		{
+			Memory.Release();
+		}
+
+		Chunk* Previous = nullptr;
+		size_t Size = 0;
+		uintptr_t Begin = 0;
+		uintptr_t Limit = 0;
+		uintptr_t Top = 0; // First free address
+		uintptr_t Last = 0; // Last allocation, 0 if the chunk is empty
+		Growth Memory;
+	};
+
+	// Sits right before every allocation in a chunk, so freeing restores the chunk as it was before
+	struct Header
+	{
+		uintptr_t PreviousTop;
+		uintptr_t PreviousLast;
+	};
+
+	static void* AllocateIn(Chunk* chunk, size_t size, size_t alignment)
+	{
+		size_t headerAlignment = alignment > alignof(Header) ? alignment : alignof(Header);
+		uintptr_t address = (chunk->Top + sizeof(Header) + headerAlignment - 1) & ~(static_cast<uintptr_t>(headerAlignment) - 1);
+		if (address <= chunk->Top || address >= chunk->Limit || size > chunk->Limit - address || !chunk->Memory.CommitFront(address + size))
+		{
+			return nullptr;
+		}
+
+		new (reinterpret_cast<void*>(address - sizeof(Header))) Header{ chunk->Top, chunk->Last };
+		chunk->Top = address + size;
+		chunk->Last = address;
+		return reinterpret_cast<void*>(address);
+	}
+
+	// Reuses the spare chunk if it is large enough, otherwise reserves a new one
+	// Chunk sizes are rounded to the slice granularity of the growth policy (pages for virtual memory)
+	Chunk* PushChunk(End side, size_t size, size_t alignment)
+	{
+		size_t granularity = Growth::GetSliceGranularity();
+		size_t overhead = alignment + sizeof(Header) + granularity;
+		if (size > SIZE_MAX - overhead)
+		{
+			return nullptr;
+		}
+		size_t chunkSize = size + overhead > mChunkSize ? size + overhead : mChunkSize;
+		chunkSize -= chunkSize % granularity;
+
+		Chunk*& top = mTops[static_cast<int>(side)];
+		Chunk*& spare = mSpares[static_cast<int>(side)];
+		Chunk* chunk = nullptr;
+		if (spare && spare->Size >= chunkSize)
+		{
+			chunk = spare;
+			spare = nullptr;
+		}
+		else
+		{
+			chunk = new (std::nothrow) Chunk();
+			if (!chunk || !chunk->Memory.Init(chunkSize, chunkSize, chunk->Begin, chunk->Limit))
+			{
+				delete chunk;
+				return nullptr;
+			}
+			chunk->Size = chunkSize;
+		}
+		chunk->Previous = top;
+		chunk->Top = chunk->Begin;
+		chunk->Last = 0;
+		++mChunkCount;
+		++mDepths[static_cast<int>(side)];
+		return top = chunk;
+	}
+
+	// The popped chunk becomes the spare, its pages are decommitted by the default decommit policy of the growth
+	void PopChunk(End side)
+	{
+		Chunk*& top = mTops[static_cast<int>(side)];
+		Chunk* chunk = top;
+		top = chunk->Previous;
+		--mChunkCount;
+		--mDepths[static_cast<int>(side)];
+		chunk->Memory.DecommitFront(chunk->Begin, chunk->Begin);
+
+		Chunk*& spare = mSpares[static_cast<int>(side)];
+		if (spare && spare->Size >= chunk->Size)
+		{
+			delete chunk;
+			return;
+		}
+		delete spare;
+		spare = chunk;
+	}
+
+	Chunk* mTops[2] = {}; // Newest chunk of each stack, indexed by End
+	Chunk* mSpares[2] = {};
+	size_t mDepths[2] = {}; // Number of chunks of each stack
+	size_t mChunkSize = DEFAULT_CHUNK_SIZE;
+	size_t mChunkCount = 0;
+	size_t mSpillCount = 0;
+	size_t mSpillBytes = 0;
+};
+
+// Intrusive record of one New/NewArray of a type with a destructor, stored right behind its objects
+// The records of each stack form a LIFO chain, so destructors run in reverse order of construction
+struct DestructorRecord
+{
+	DestructorRecord* Previous;
+	void (*Destroy)(void* objects, size_t count);
+	void* Objects;
+	size_t Count;
+};
+
+/**
+* You work on your DoubleEndedStackAllocator. Stick to the provided interface, this is
+* necessary for testing your assignment in the end. Don't remove or rename the public
+* interface of the allocator. Also don't add any additional initialization code, the
+* allocator needs to work after it was created and its constructor was called. You can
+* add additional public functions but those should only be used for your own testing.
+**/
+template<class BoundsCheckPolicy, class MetaDataPolicy, class GrowthPolicy, class ErrorPolicy, class StatsPolicy = NoStats, class TracePolicy = NoTrace, class FallbackPolicy = NoFallback>
+class DoubleEndedStackAllocatorT
+{
+	static_assert(BoundsCheckPolicy::GUARD_THRESHOLD == 0 || GrowthPolicy::SUPPORTS_GUARD_PAGES, "Guard pages need a growth policy on virtual memory");
+
+public:
+	using Growth = GrowthPolicy;
+
+	// Ctor throws bad alloc exception if not enough memory is available
+	// --> otherwise we would need to either the object as "not usable" and try to reserve memory at alloc calls
+	// Using default param realMaxSize to be able to reserve a given amount of virtual memory for testing
+	// realMaxSize is only used by growth policies which reserve virtual memory
+	explicit DoubleEndedStackAllocatorT(size_t max_size, size_t realMaxSize = GrowthPolicy::DEFAULT_RESERVE_SIZE)
+	{
+		// Ensure we are working on fitting size types
+		static_assert(sizeof(size_t) == sizeof(uintptr_t), "Size mismatch of size_t and uintptr_t");
+
+		if (!mGrowth.Init(max_size, realMaxSize, mBegin, mEnd))
+		{
+			ErrorPolicy::Report(AllocatorError::ConstructionFailed, "Not enough memory to construct!");
+			throw std::bad_alloc();
+		}
+
+		mFront = mFrontTop = mBegin;
+		mBack = mBackTop = mEnd;
+	}
+
+	// Same as above, options select how growth policies reserve and commit virtual memory (e.g. huge pages)
+	DoubleEndedStackAllocatorT(size_t max_size, const VirtualMemoryOptions& options, size_t realMaxSize = GrowthPolicy::DEFAULT_RESERVE_SIZE)
+	{
+		mGrowth.SetOptions(options);
+		if (!mGrowth.Init(max_size, realMaxSize, mBegin, mEnd))
+		{
+			ErrorPolicy::Report(AllocatorError::ConstructionFailed, "Not enough memory to construct!");
+			throw std::bad_alloc();
+		}
+
+		mFront = mFrontTop = mBegin;
+		mBack = mBackTop = mEnd;
+
+		// Prewarming is an optimization only, the allocator is usable even if it fails
+		if (options.Prewarm.FrontBytes || options.Prewarm.BackBytes)
+		{
+			Prewarm(options.Prewarm.FrontBytes, options.Prewarm.BackBytes, options.PrewarmAsync);
+		}
+	}
+
+	// Works on memory owned by somebody else: a reserved (uncommitted) range for growing allocators, a usable buffer otherwise
+	// The memory is not released on destruction
+	DoubleEndedStackAllocatorT(void* memory, size_t size)
+	{
+		if (!mGrowth.InitExternal(memory, size, mBegin, mEnd))
+		{
+			ErrorPolicy::Report(AllocatorError::ConstructionFailed, "Could not use external memory to construct!");
+			throw std::bad_alloc();
+		}
+
+		mFront = mFrontTop = mBegin;
+		mBack = mBackTop = mEnd;
+	}
+
+	~DoubleEndedStackAllocatorT(void)
+	{
+		// Objects created with New are destroyed even if the stacks weren't reset
+		DestroyObjectsTo(::End::Front, nullptr);
+		DestroyObjectsTo(::End::Back, nullptr);
+		HTL_UNPOISON_MEMORY(mBegin, mEnd - mBegin);
+
+		// Release reserved memory back to system
+		mGrowth.Release();
+	}
+
+	// Allocate given amount of memory with alignment
+	// If there is not enough memory left or input params are invalid -> assert and returns a nullptr
+	void* Allocate(size_t size, size_t alignment)
+	{
+		if (!CheckAllocateParameters(size, alignment))
+		{
+			return nullptr;
+		}
+		return AllocateFrontUnchecked(size, alignment);
+	}
+
+	void* AllocateBack(size_t size, size_t alignment)
+	{
+		if (!CheckAllocateParameters(size, alignment))
+		{
+			return nullptr;
+		}
+		return AllocateBackUnchecked(size, alignment);
+	}
+
+	// Same as Allocate, but failures are only returned and never reach the error policy (no output, no assert)
+	// Meant for probing the remaining capacity
+	AllocationResult TryAllocate(size_t size, size_t alignment)
+	{
+		AllocationResult result{ nullptr, ValidateAllocateParameters(size, alignment) };
+		if (result.Error == AllocatorError::None)
+		{
+			result.Memory = TryAllocateFrontUnchecked(size, alignment, result.Error);
+		}
+		return result;
+	}
+
+	AllocationResult TryAllocateBack(size_t size, size_t alignment)
+	{
+		AllocationResult result{ nullptr, ValidateAllocateParameters(size, alignment) };
+		if (result.Error == AllocatorError::None)
+		{
+			result.Memory = TryAllocateBackUnchecked(size, alignment, result.Error);
+		}
+		return result;
+	}
+
+	// Hot path with compile-time size and alignment, parameters are checked by static_asserts instead of at runtime
+	template<class T>
+	T* Allocate(void)
+	{
+		return static_cast<T*>(Allocate<sizeof(T), alignof(T)>());
+	}
+
+	template<size_t Size, size_t Alignment>
+	void* Allocate(void)
+	{
+		static_assert(Size > 0, "Size to allocate is zero");
+		static_assert(Alignment > 0 && !(Alignment & (Alignment - 1)), "Alignment for allocate musst be a power of 2!");
+		return AllocateFrontUnchecked(Size, Alignment);
+	}
+
+	template<class T>
+	T* AllocateBack(void)
+	{
+		return static_cast<T*>(AllocateBack<sizeof(T), alignof(T)>());
+	}
+
+	template<size_t Size, size_t Alignment>
+	void* AllocateBack(void)
+	{
+		static_assert(Size > 0, "Size to allocate is zero");
+		static_assert(Alignment > 0 && !(Alignment & (Alignment - 1)), "Alignment for allocate musst be a power of 2!");
+		return AllocateBackUnchecked(Size, Alignment);
+	}
+
+	// Constructs objects in place, their destructors run on Free, FreeToMarker, Reset and destruction in reverse order
+	// Trivially destructible types are plain allocations, all others get a DestructorRecord behind the objects
+	// Don't Reallocate the returned memory, the record would be lost
+	template<class T, class... Args>
+	T* New(Args&&... args)
+	{
+		return Construct<T>(::End::Front, 1, std::forward<Args>(args)...);
+	}
+
+	template<class T, class... Args>
+	T* NewBack(Args&&... args)
+	{
+		return Construct<T>(::End::Back, 1, std::forward<Args>(args)...);
+	}
+
+	// Value-initialized array, freed with the returned pointer
+	template<class T>
+	T* NewArray(size_t count)
+	{
+		return Construct<T>(::End::Front, count);
+	}
+
+	template<class T>
+	T* NewArrayBack(size_t count)
+	{
+		return Construct<T>(::End::Back, count);
+	}
+
+	// Allocates count elements with a stride of size rounded up to alignment as one allocation
+	// The whole array has one canary pair and one meta data record, free it with the returned pointer
+	void* AllocateArray(size_t count, size_t size, size_t alignment)
+	{
+		size_t totalSize = 0;
+		if (!GetArraySize(count, size, alignment, totalSize))
+		{
+			return nullptr;
+		}
+		return AllocateFrontUnchecked(totalSize, alignment);
+	}
+
+	void* AllocateArrayBack(size_t count, size_t size, size_t alignment)
+	{
+		size_t totalSize = 0;
+		if (!GetArraySize(count, size, alignment, totalSize))
+		{
+			return nullptr;
+		}
+		return AllocateBackUnchecked(totalSize, alignment);
+	}
+
+	// Allocates count blocks of different sizes as one allocation, out receives the aligned address of every block
+	// Returns the group (same as out[0]) which has to be freed as a whole, nullptr if the batch doesn't fit
+	void* AllocateBatch(const size_t* sizes, size_t count, size_t alignment, void** out)
+	{
+		size_t totalSize = 0;
+		if (!GetBatchSize(sizes, count, alignment, totalSize))
+		{
+			return nullptr;
+		}
+		void* group = AllocateFrontUnchecked(totalSize, alignment);
+		SplitBatch(group, sizes, count, alignment, out);
+		return group;
+	}
+
+	void* AllocateBatchBack(const size_t* sizes, size_t count, size_t alignment, void** out)
+	{
+		size_t totalSize = 0;
+		if (!GetBatchSize(sizes, count, alignment, totalSize))
+		{
+			return nullptr;
+		}
+		void* group = AllocateBackUnchecked(totalSize, alignment);
+		SplitBatch(group, sizes, count, alignment, out);
+		return group;
+	}
+
+	// Free previously allocated memory
+	// Does nothing if provided address does not fit last allocation (LIFO requirement)
+	// Asserts if detects overwritten canaries if canaries are enabled
+	// Without meta data individual allocations can't be freed, use markers or Reset instead
+	void Free(void* memory)
+	{
+		if (FallbackPolicy::ENABLED && (mFallback.IsSpilling(::End::Front) || mFallback.IsLast(::End::Front, memory)))
+		{
+			FreeSpill(::End::Front, memory);
+			return;
+		}
+		if (mFront != mBegin && FreeMemoryAndUpdatePointer(::End::Front, reinterpret_cast<uintptr_t>(memory), mFront))
+		{
+			// Destructors only run for a validated free, the memory stays intact until it is released below
+			DestroyObjectsOnFree(::End::Front, reinterpret_cast<uintptr_t>(memory));
+			uintptr_t oldTop = mFrontTop;
+			mFrontTop = GetFrontTop(mFront);
+			mStats.OnFree(::End::Front);
+			mTrace.Record(TraceOp::Free, ::End::Front, 0, 0);
+			ReleaseFront(oldTop);
+		}
+	}
+
+	void FreeBack(void* memory)
+	{
+		if (FallbackPolicy::ENABLED && (mFallback.IsSpilling(::End::Back) || mFallback.IsLast(::End::Back, memory)))
+		{
+			FreeSpill(::End::Back, memory);
+			return;
+		}
+		if (mBack != mEnd && FreeMemoryAndUpdatePointer(::End::Back, reinterpret_cast<uintptr_t>(memory), mBack))
+		{
+			DestroyObjectsOnFree(::End::Back, reinterpret_cast<uintptr_t>(memory));
+			uintptr_t oldTop = mBackTop;
+			mBackTop = GetBackTop(mBack);
+			mStats.OnFree(::End::Back);
+			mTrace.Record(TraceOp::Free, ::End::Back, 0, 0);
+			ReleaseBack(oldTop);
+		}
+	}
+
+	// Frees the allocation only if it is the last one of its stack, returns false without any error otherwise
+	// Used by the container adapters, where non-LIFO deallocations are expected and simply deferred until Reset
+	bool TryFree(void* memory)
+	{
+		if (FallbackPolicy::ENABLED && mFallback.IsLast(::End::Front, memory))
+		{
+			FreeSpill(::End::Front, memory);
+			return true;
+		}
+		if (!MetaDataPolicy::SUPPORTS_FREE || mFallback.IsSpilling(::End::Front) || mFront == mBegin || reinterpret_cast<uintptr_t>(memory) != mFront)
+		{
+			return false;
+		}
+		Free(memory);
+		return true;
+	}
+
+	bool TryFreeBack(void* memory)
+	{
+		if (FallbackPolicy::ENABLED && mFallback.IsLast(::End::Back, memory))
+		{
+			FreeSpill(::End::Back, memory);
+			return true;
+		}
+		if (!MetaDataPolicy::SUPPORTS_FREE || mFallback.IsSpilling(::End::Back) || mBack == mEnd || reinterpret_cast<uintptr_t>(memory) != mBack)
+		{
+			return false;
+		}
+		FreeBack(memory);
+		return true;
+	}
+
+	// Resizes an allocation, the last allocation of the stack grows or shrinks in place if it meets the alignment
+	// Any other allocation is copied to a new allocation with the given alignment and the old one is left until it's released
+	// Returns a nullptr if there is not enough memory left, the old allocation stays valid in this case
+	void* Reallocate(void* memory, size_t newSize, size_t alignment = alignof(std::max_align_t))
+	{
+		if (!memory)
+		{
+			return Allocate(newSize, alignment);
+		}
+		if (!CheckAllocateParameters(newSize, alignment))
+		{
+			return nullptr;
+		}
+
+		uintptr_t address = reinterpret_cast<uintptr_t>(memory);
+		if (mFront == mBegin || address != mFront || (address & (alignment - 1)))
+		{
+			return ReallocateByCopy(::End::Front, memory, newSize, alignment);
+		}
+		// A guarded allocation can't grow into its guard page, and a large one needs a guard page of its own
+		if (BoundsCheckPolicy::GUARD_THRESHOLD && (newSize >= BoundsCheckPolicy::GUARD_THRESHOLD || mGrowth.GetGuardEnd(::End::Front, mFront)))
+		{
+			return ReallocateByCopy(::End::Front, memory, newSize, alignment);
+		}
+
+		// The front top allocation always ends right before its end canary, so this works without meta data too
+		if (newSize >= mBackTop - mFront - CANARY_SIZE)
+		{
+			ErrorPolicy::Assert(AllocatorError::Overlap, "Front Stack overlaps with Back Stack!");
+			return nullptr;
+		}
+
+		uintptr_t newTop = mFront + newSize + CANARY_SIZE;
+		if (newTop > mFrontTop && !mGrowth.CommitFront(newTop))
+		{
+			ErrorPolicy::Assert(AllocatorError::CommitFailed, "Could not commit additional front page!");
+			return nullptr;
+		}
+		if (newTop > mFrontTop)
+		{
+			HTL_UNPOISON_MEMORY(mFrontTop, newTop - mFrontTop);
+		}
+
+		MetaRecord record = mMeta.Read(::End::Front, mFront);
+		mMeta.Pop(::End::Front);
+		if (!mMeta.Write(::End::Front, mFront, record.LastItem, newSize))
+		{
+			// The old record fits, it was stored at the same place before
+			mMeta.Write(::End::Front, mFront, record.LastItem, record.Size);
+			if (newTop > mFrontTop)
+			{
+				HTL_POISON_MEMORY(mFrontTop, newTop - mFrontTop);
+			}
+			ErrorPolicy::Assert(AllocatorError::MetaDataFailed, "Could not store meta data");
+			return nullptr;
+		}
+		if (BoundsCheckPolicy::ENABLED)
+		{
+			BoundsCheckPolicy::WriteCanary(mFront + newSize);
+		}
+
+		uintptr_t oldTop = mFrontTop;
+		mFrontTop = newTop;
+		mStats.OnResize(::End::Front, mFrontTop - mBegin);
+		mTrace.Record(TraceOp::Reallocate, ::End::Front, newSize, alignment);
+		if (newTop < oldTop)
+		{
+			ReleaseFront(oldTop);
+		}
+		return memory;
+	}
+
+	// The back stack grows downwards, so growing in place moves the allocation to a lower address
+	// Always use the returned pointer, the content is moved along
+	void* ReallocateBack(void* memory, size_t newSize, size_t alignment = alignof(std::max_align_t))
+	{
+		if (!memory)
+		{
+			return AllocateBack(newSize, alignment);
+		}
+		if (!CheckAllocateParameters(newSize, alignment))
+		{
+			return nullptr;
+		}
+
+		uintptr_t address = reinterpret_cast<uintptr_t>(memory);
+		if (mBack == mEnd || address != mBack)
+		{
+			return ReallocateByCopy(::End::Back, memory, newSize, alignment);
+		}
+		if (BoundsCheckPolicy::GUARD_THRESHOLD && (newSize >= BoundsCheckPolicy::GUARD_THRESHOLD || mGrowth.GetGuardEnd(::End::Back, mBack)))
+		{
+			return ReallocateByCopy(::End::Back, memory, newSize, alignment);
+		}
+		if (!MetaDataPolicy::SUPPORTS_FREE)
+		{
+			ErrorPolicy::Assert(AllocatorError::Unsupported, "Reallocate on the back stack is not supported without meta data");
+			return nullptr;
+		}
+
+		// The upper end of the allocation stays where it is
+		MetaRecord record = mMeta.Read(::End::Back, mBack);
+		uintptr_t allocationEnd = mBack + record.Size;
+		uintptr_t alignedAddress = 0;
+		if (newSize >= allocationEnd - mFrontTop
+			|| (alignedAddress = AlignDown(allocationEnd - newSize, alignment)) <= mFrontTop + META_SIZE + CANARY_SIZE)
+		{
+			ErrorPolicy::Assert(AllocatorError::Overlap, "Back Stack overlaps with Front Stack");
+			return nullptr;
+		}
+
+		uintptr_t newTop = alignedAddress - META_SIZE - CANARY_SIZE;
+		if (newTop < mBackTop && !mGrowth.CommitBack(newTop))
+		{
+			ErrorPolicy::Assert(AllocatorError::CommitFailed, "Could not commit additional end page");
+			return nullptr;
+		}
+		if (newTop < mBackTop)
+		{
+			HTL_UNPOISON_MEMORY(newTop, mBackTop - newTop);
+		}
+
+		// Move the content first, the new header may overlap the old content when shrinking
+		memmove(reinterpret_cast<void*>(alignedAddress), memory, newSize < record.Size ? newSize : record.Size);
+		mMeta.Pop(::End::Back);
+		if (!mMeta.Write(::End::Back, alignedAddress, record.LastItem, newSize))
+		{
+			// Only a growing record can fail, then the whole old content was moved and can be moved back
+			memmove(memory, reinterpret_cast<void*>(alignedAddress), record.Size);
+			mMeta.Write(::End::Back, mBack, record.LastItem, record.Size);
+			if (BoundsCheckPolicy::ENABLED)
+			{
+				BoundsCheckPolicy::WriteCanary(mBackTop);
+			}
+			if (newTop < mBackTop)
+			{
+				HTL_POISON_MEMORY(newTop, mBackTop - newTop);
+			}
+			ErrorPolicy::Assert(AllocatorError::MetaDataFailed, "Could not store meta data");
+			return nullptr;
+		}
+		if (BoundsCheckPolicy::ENABLED)
+		{
+			BoundsCheckPolicy::WriteCanary(newTop);
+			BoundsCheckPolicy::WriteCanary(alignedAddress + newSize);
+		}
+
+		uintptr_t oldTop = mBackTop;
+		mBack = alignedAddress;
+		mBackTop = newTop;
+		mStats.OnResize(::End::Back, mEnd - mBackTop);
+		mTrace.Record(TraceOp::Reallocate, ::End::Back, newSize, alignment);
+		if (newTop > oldTop)
+		{
+			ReleaseBack(oldTop);
+		}
+		return reinterpret_cast<void*>(alignedAddress);
+	}
+
+	// Resets both stacks in constant time by just setting the internal pointers
+	// Skips pointer and canary validation, use ResetValidated() if all allocations should be checked
+	void Reset(void)
+	{
+		ResetFront();
+		ResetBack();
+	}
+
+	void ResetFront(void)
+	{
+		mTrace.Record(TraceOp::Reset, ::End::Front, 0, 0);
+		DestroyObjectsTo(::End::Front, nullptr);
+		mFallback.Reset(::End::Front);
+		uintptr_t oldTop = mFrontTop;
+		mFront = mFrontTop = mBegin;
+		mMeta.Clear(::End::Front);
+		ReleaseFront(oldTop);
+	}
+
+	void ResetBack(void)
+	{
+		mTrace.Record(TraceOp::Reset, ::End::Back, 0, 0);
+		DestroyObjectsTo(::End::Back, nullptr);
+		mFallback.Reset(::End::Back);
+		uintptr_t oldTop = mBackTop;
+		mBack = mBackTop = mEnd;
+		mMeta.Clear(::End::Back);
+		ReleaseBack(oldTop);
+	}
+
+	// Debug sweep: frees every allocation in LIFO order, which validates pointers and canaries (if enabled)
+	// Cost is linear in the number of live allocations, without meta data this is the same as Reset()
+	void ResetValidated(void)
+	{
+		if (!MetaDataPolicy::SUPPORTS_FREE)
+		{
+			Reset();
+			return;
+		}
+
+		// A rejected free (e.g. corrupted meta data) was already reported, the rest of the chain can't be trusted
+		while (mFront != mBegin)
+		{
+			uintptr_t front = mFront;
+			Free(reinterpret_cast<void*>(mFront));
+			if (mFront == front)
+			{
+				ResetFront();
+			}
+		}
+
+		while (mBack != mEnd)
+		{
+			uintptr_t back = mBack;
+			FreeBack(reinterpret_cast<void*>(mBack));
+			if (mBack == back)
+			{
+				ResetBack();
+			}
+		}
+		DestroyObjectsTo(::End::Front, nullptr);
+		DestroyObjectsTo(::End::Back, nullptr);
+		mFallback.Reset(::End::Front);
+		mFallback.Reset(::End::Back);
+	}
+
+	// A marker remembers the top of one stack, everything allocated after it can be released at once
+	struct Marker
+	{
+		uintptr_t Position;
+		uintptr_t Top;
+		size_t MetaDepth;
+		DestructorRecord* Destructors;
+		typename FallbackPolicy::Position Spill;
+		::End Side;
+	};
+
+	Marker GetFrontMarker(void) const
+	{
+		return Marker{ mFront, mFrontTop, mMeta.GetDepth(::End::Front), mDestructors[static_cast<int>(::End::Front)], mFallback.GetPosition(::End::Front), ::End::Front };
+	}
+
+	Marker GetBackMarker(void) const
+	{
+		return Marker{ mBack, mBackTop, mMeta.GetDepth(::End::Back), mDestructors[static_cast<int>(::End::Back)], mFallback.GetPosition(::End::Back), ::End::Back };
+	}
+
+	// Releases all allocations of the marker's stack which were made after the marker was taken
+	// A marker which was already released (stack is below the marker) is reported as InvalidPointer and nothing is freed
+	// With canaries and meta data the released range is walked and its canaries are checked, otherwise this is O(1)
+	void FreeToMarker(const Marker& marker)
+	{
+		if (marker.Side == ::End::Front)
+		{
+			if (marker.Top < mBegin || marker.Top > mFrontTop)
+			{
+				ErrorPolicy::Assert(AllocatorError::InvalidPointer, "Front marker is not in range of the front stack, couldn't free memory");
+				return;
+			}
+			if (!CheckChainToMarker(::End::Front, mFront, marker.Position, mBegin))
+			{
+				return;
+			}
+			DestroyObjectsTo(::End::Front, marker.Destructors);
+			mFallback.FreeToPosition(::End::Front, marker.Spill);
+			uintptr_t oldTop = mFrontTop;
+			mFront = marker.Position;
+			mFrontTop = marker.Top;
+			mMeta.FreeToDepth(::End::Front, marker.MetaDepth);
+			ReleaseFront(oldTop);
+		}
+		else
+		{
+			if (marker.Top > mEnd || marker.Top < mBackTop)
+			{
+				ErrorPolicy::Assert(AllocatorError::InvalidPointer, "Back marker is not in range of the back stack, couldn't free memory");
+				return;
+			}
+			if (!CheckChainToMarker(::End::Back, mBack, marker.Position, mEnd))
+			{
+				return;
+			}
+			DestroyObjectsTo(::End::Back, marker.Destructors);
+			mFallback.FreeToPosition(::End::Back, marker.Spill);
+			uintptr_t oldTop = mBackTop;
+			mBack = marker.Position;
+			mBackTop = marker.Top;
+			mMeta.FreeToDepth(::End::Back, marker.MetaDepth);
+			ReleaseBack(oldTop);
+		}
+	}
+
+	void SetDecommitPolicy(const DecommitPolicy& policy)
+	{
+		mGrowth.SetDecommitPolicy(policy);
+		DecommitFrontPages();
+		DecommitBackPages();
+	}
+
+	size_t GetCommittedSize(void) const
+	{
+		return mGrowth.GetCommittedSize(mBegin, mEnd);
+	}
+
+	bool UsesHugePages(void) const
+	{
+		return mGrowth.UsesHugePages();
+	}
+
+	// Commits and faults in the first frontBytes of the front stack and the last backBytes of the back stack,
+	// so the first allocations don't pay for page faults
+	// Only the free memory between the tops is touched, live allocations (and their guard pages) are skipped
+	// With async the pages are committed right away and faulted in by a background thread if the system supports it
+	bool Prewarm(size_t frontBytes, size_t backBytes, bool async = false)
+	{
+		if (frontBytes > mEnd - mBegin || backBytes > mEnd - mBegin)
+		{
+			ErrorPolicy::Assert(AllocatorError::InvalidSize, "Prewarm size is larger than the allocator");
+			return false;
+		}
+		uintptr_t frontEnd = mBegin + frontBytes;
+		frontEnd = frontEnd < mFrontTop ? mFrontTop : (frontEnd > mBackTop ? mBackTop : frontEnd);
+		uintptr_t backStart = mEnd - backBytes;
+		backStart = backStart > mBackTop ? mBackTop : (backStart < mFrontTop ? mFrontTop : backStart);
+		if (!mGrowth.Prewarm(mFrontTop, frontEnd, backStart, mBackTop, async))
+		{
+			ErrorPolicy::Assert(AllocatorError::CommitFailed, "Could not prewarm memory");
+			return false;
+		}
+		return true;
+	}
+
+	// Highest committed memory per stack, can be passed to VirtualMemoryOptions::Prewarm of the next run
+	CommitWatermark GetCommitWatermark(void) const
+	{
+		return mGrowth.GetCommitWatermark(mBegin, mEnd);
+	}
+
+	// Memory which is committed ahead but not used by any allocation yet
+	size_t GetCommitAheadSize(void) const
+	{
+		return GetCommittedSize() - GetUsedSize();
+	}
+
+	AllocatorStats GetStats(void) const
+	{
+		AllocatorStats stats;
+		mStats.Fill(stats);
+		mGrowth.FillStats(stats);
+		mFallback.FillStats(stats);
+		stats.LiveBytes[static_cast<int>(::End::Front)] = mFrontTop - mBegin;
+		stats.LiveBytes[static_cast<int>(::End::Back)] = mEnd - mBackTop;
+		for (int i = 0; i < 2; ++i)
+		{
+			if (stats.PeakBytes[i] < stats.LiveBytes[i])
+			{
+				stats.PeakBytes[i] = stats.LiveBytes[i];
+			}
+		}
+		stats.CommittedBytes = GetCommittedSize();
+		stats.CommitAheadBytes = GetCommitAheadSize();
+		stats.ReservedBytes = mEnd - mBegin;
+		stats.MetaTableBytes = mMeta.GetTableSize();
+		return stats;
+	}
+
+	// Recorded allocation stream, only filled with a tracing policy (see RingBufferTrace)
+	// Releasing memory with markers is not recorded
+	TracePolicy& GetTrace(void)
+	{
+		return mTrace;
+	}
+
+	// Only useful to configure the fallback, e.g. the chunk size of ChainedFallback
+	FallbackPolicy& GetFallback(void)
+	{
+		return mFallback;
+	}
+
+	// Counters are only reset with a collecting stats policy, the peaks start again at the current usage
+	void ResetStats(void)
+	{
+		mStats = StatsPolicy();
+		mFallback.ResetStats();
+	}
+
+	void DumpStats(FILE* file = stdout) const
+	{
+		AllocatorStats stats = GetStats();
+		fprintf(file, "[Stats] %-12s %14s %14s\n", "", "front", "back");
+		fprintf(file, "[Stats] %-12s %14zu %14zu\n", "live", stats.LiveBytes[0], stats.LiveBytes[1]);
+		fprintf(file, "[Stats] %-12s %14zu %14zu\n", "peak", stats.PeakBytes[0], stats.PeakBytes[1]);
+		if (StatsPolicy::ENABLED)
+		{
+			fprintf(file, "[Stats] %-12s %14zu %14zu\n", "allocations", stats.AllocationCount[0], stats.AllocationCount[1]);
+			fprintf(file, "[Stats] %-12s %14zu %14zu\n", "frees", stats.FreeCount[0], stats.FreeCount[1]);
+			fprintf(file, "[Stats] requested %zu, padding %zu, canaries %zu, meta data %zu bytes\n",
+				stats.RequestedBytes, stats.PaddingBytes, stats.CanaryBytes, stats.MetaBytes);
+		}
+		fprintf(file, "[Stats] committed %zu (ahead %zu) of %zu reserved bytes, %zu commits, %zu decommits\n",
+			stats.CommittedBytes, stats.CommitAheadBytes, stats.ReservedBytes, stats.CommitCount, stats.DecommitCount);
+		if (FallbackPolicy::ENABLED)
+		{
+			fprintf(file, "[Stats] spilled %zu allocations, %zu bytes, %zu chunks\n", stats.SpillCount, stats.SpillBytes, stats.ChunkCount);
+		}
+	}
+
+	// Bytes used by both stacks including padding, canaries and meta data
+	size_t GetUsedSize(void) const
+	{
+		return (mFrontTop - mBegin) + (mEnd - mBackTop);
+	}
+
+	// Per-thread instances, every thread gets its own allocator on a slice of one shared reservation
+	// ConfigureThreadArenas has to be called before the first ThisThread() call, otherwise the defaults are used
+	static bool ConfigureThreadArenas(size_t sliceSize, size_t maxThreads)
+	{
+		return ThreadArenaRegistry<DoubleEndedStackAllocatorT>::Get().Configure(sliceSize, maxThreads);
+	}
+
+	static DoubleEndedStackAllocatorT& ThisThread(void)
+	{
+		return ThreadArenaRegistry<DoubleEndedStackAllocatorT>::Get().ThisThread();
+	}
+
+	// Resets the allocators of all threads, only allowed while no thread allocates (e.g. at frame boundaries)
+	static void ResetAll(void)
+	{
+		ThreadArenaRegistry<DoubleEndedStackAllocatorT>::Get().ResetAll();
+	}
+
+	// Needed for testing
+	const void* Begin()
+	{
+		return reinterpret_cast<void*>(mBegin);
+	}
+
+	const void* Front()
+	{
+		return reinterpret_cast<void*>(mFront);
+	}
+
+	const void* End()
+	{
+		return reinterpret_cast<void*>(mEnd);
+	}
+
+	const void* Back()
+	{
+		return reinterpret_cast<void*>(mBack);
+	}
+
+	static size_t GetCanaraySize()
+	{
+		return CANARY_SIZE;
+	}
+
+	static size_t GetMetaSize()
+	{
+		return META_SIZE;
+	}
+
+private:
+	// Because no interface was given and the auto-generated default copy/move ctor would cause problems
+	// We either have to implement our own custom functionality or remove them
+	// -> We decided to prevent copy and move because in this context to us it does not make much sense
+	// to copy or move a created allocator and we didn't want to crack our heads on errors, undefined behavior
+	// or the usage of an internal mapping table to support invalidated pointers
+	DoubleEndedStackAllocatorT(const DoubleEndedStackAllocatorT&) = delete;
+	DoubleEndedStackAllocatorT& operator = (const DoubleEndedStackAllocatorT&) = delete;
+	DoubleEndedStackAllocatorT(const DoubleEndedStackAllocatorT&&) = delete;
+	DoubleEndedStackAllocatorT& operator = (const DoubleEndedStackAllocatorT&&) = delete;
+
+	// Allocation without parameter validation, alignment has to be a power of 2 and size non zero
+	void* AllocateFrontUnchecked(size_t size, size_t alignment)
+	{
+		AllocatorError error = AllocatorError::None;
+		void* memory = TryAllocateFrontUnchecked(size, alignment, error);
+		if (HTL_UNLIKELY(!memory))
+		{
+			ReportAllocationError(::End::Front, error);
+		}
+		return memory;
+	}
+
+	void* AllocateBackUnchecked(size_t size, size_t alignment)
+	{
+		AllocatorError error = AllocatorError::None;
+		void* memory = TryAllocateBackUnchecked(size, alignment, error);
+		if (HTL_UNLIKELY(!memory))
+		{
+			ReportAllocationError(::End::Back, error);
+		}
+		return memory;
+	}
+
+	// Failures only set the error, reporting is up to the caller
+	void* TryAllocateFrontUnchecked(size_t size, size_t alignment, AllocatorError& error)
+	{
+		// A stack which spilled into a chain of chunks continues there until they are drained, so LIFO order holds
+		if (FallbackPolicy::ENABLED && HTL_UNLIKELY(mFallback.IsSpilling(::End::Front)))
+		{
+			return Spill(::End::Front, size, alignment, AllocatorError::Overlap, error);
+		}
+		if (BoundsCheckPolicy::GUARD_THRESHOLD && size >= BoundsCheckPolicy::GUARD_THRESHOLD)
+		{
+			return TryAllocateFrontGuarded(size, alignment, error);
+		}
+
+		// Search for aligned address with offset for canary and meta
+		// mFrontTop is the next free address, so the previous allocation doesn't need to be read
+		uintptr_t alignedAddress = AlignUp(mFrontTop + CANARY_SIZE + META_SIZE, alignment);
+
+		// Check if front allocation would overlap with back allocation (alignedAddress + size + CANARY_SIZE >= mBackTop)
+		// mBackTop is mEnd if there are no back allocations -> more space for front
+		if (HTL_UNLIKELY(alignedAddress + CANARY_SIZE >= mBackTop || size >= mBackTop - alignedAddress - CANARY_SIZE))
+		{
+			return Spill(::End::Front, size, alignment, AllocatorError::Overlap, error);
+		}
+
+		uintptr_t newTop = alignedAddress + size + CANARY_SIZE;
+		if (HTL_UNLIKELY(!mGrowth.CommitFront(newTop)))
+		{
+			return Spill(::End::Front, size, alignment, AllocatorError::CommitFailed, error);
+		}
+		HTL_UNPOISON_MEMORY(mFrontTop, newTop - mFrontTop);
+
+		if (BoundsCheckPolicy::ENABLED)
+		{
+			BoundsCheckPolicy::WriteCanary(alignedAddress - META_SIZE - CANARY_SIZE);
+			BoundsCheckPolicy::WriteCanary(alignedAddress + size);
+		}
+		if (HTL_UNLIKELY(!mMeta.Write(::End::Front, alignedAddress, mFront, size)))
+		{
+			error = AllocatorError::MetaDataFailed;
+			return nullptr;
+		}
+
+		mStats.OnAllocate(::End::Front, size, alignedAddress - META_SIZE - CANARY_SIZE - mFrontTop, 2 * CANARY_SIZE, META_SIZE, newTop - mBegin);
+		mTrace.Record(TraceOp::Allocate, ::End::Front, size, alignment);
+		mFront = alignedAddress;
+		mFrontTop = newTop;
+		return reinterpret_cast<void*>(alignedAddress);
+	}
+
+	void* TryAllocateBackUnchecked(size_t size, size_t alignment, AllocatorError& error)
+	{
+		if (FallbackPolicy::ENABLED && HTL_UNLIKELY(mFallback.IsSpilling(::End::Back)))
+		{
+			return Spill(::End::Back, size, alignment, AllocatorError::Overlap, error);
+		}
+		if (BoundsCheckPolicy::GUARD_THRESHOLD && size >= BoundsCheckPolicy::GUARD_THRESHOLD)
+		{
+			return TryAllocateBackGuarded(size, alignment, error);
+		}
+
+		// Check if back allocation would overlap with front allocation (alignedAddress - META_SIZE - CANARY_SIZE <= mFrontTop)
+		// mFrontTop is mBegin if there are no front allocations -> more space for back
+		uintptr_t alignedAddress = 0;
+		if (HTL_UNLIKELY(size >= mBackTop - mFrontTop
+			|| (alignedAddress = AlignDown(mBackTop - CANARY_SIZE - size, alignment)) <= mFrontTop + META_SIZE + CANARY_SIZE))
+		{
+			return Spill(::End::Back, size, alignment, AllocatorError::Overlap, error);
+		}
+
+		uintptr_t newTop = alignedAddress - META_SIZE - CANARY_SIZE;
+		if (HTL_UNLIKELY(!mGrowth.CommitBack(newTop)))
+		{
+			return Spill(::End::Back, size, alignment, AllocatorError::CommitFailed, error);
+		}
+		HTL_UNPOISON_MEMORY(newTop, mBackTop - newTop);
+
+		if (BoundsCheckPolicy::ENABLED)
+		{
+			BoundsCheckPolicy::WriteCanary(newTop);
+			BoundsCheckPolicy::WriteCanary(alignedAddress + size);
+		}
+		if (HTL_UNLIKELY(!mMeta.Write(::End::Back, alignedAddress, mBack, size)))
+		{
+			error = AllocatorError::MetaDataFailed;
+			return nullptr;
+		}
+
+		mStats.OnAllocate(::End::Back, size, mBackTop - alignedAddress - size - CANARY_SIZE, 2 * CANARY_SIZE, META_SIZE, mEnd - newTop);
+		mTrace.Record(TraceOp::Allocate, ::End::Back, size, alignment);
+		mBack = alignedAddress;
+		mBackTop = newTop;
+		return reinterpret_cast<void*>(alignedAddress);
+	}
+
+	// The allocation ends right at a guard page (only alignment padding in between), so overruns fault immediately
+	// The guard page belongs to the allocation and is part of the stack until the allocation is released
+	void* TryAllocateFrontGuarded(size_t size, size_t alignment, AllocatorError& error)
+	{
+		size_t pageSize = mGrowth.GetPageSize();
+		uintptr_t minAddress = mFrontTop + CANARY_SIZE + META_SIZE;
+		if (minAddress >= mBackTop || size >= mBackTop - minAddress)
+		{
+			return Spill(::End::Front, size, alignment, AllocatorError::Overlap, error);
+		}
+
+		uintptr_t guard = AlignUp(minAddress + size, pageSize);
+		uintptr_t alignedAddress = AlignDown(guard - size, alignment);
+		if (alignedAddress < minAddress)
+		{
+			alignedAddress = AlignUp(minAddress, alignment);
+			guard = AlignUp(alignedAddress + size, pageSize);
+		}
+		uintptr_t newTop = guard + pageSize;
+		if (guard < alignedAddress || newTop < guard || newTop > mBackTop)
+		{
+			return Spill(::End::Front, size, alignment, AllocatorError::Overlap, error);
+		}
+		if (!mGrowth.CommitFront(newTop) || !mGrowth.AddGuardPage(::End::Front, alignedAddress, guard))
+		{
+			return Spill(::End::Front, size, alignment, AllocatorError::CommitFailed, error);
+		}
+		HTL_UNPOISON_MEMORY(mFrontTop, guard - mFrontTop);
+
+		if (!mMeta.Write(::End::Front, alignedAddress, mFront, size))
+		{
+			mGrowth.ReleaseGuardPages(::End::Front, mFront);
+			error = AllocatorError::MetaDataFailed;
+			return nullptr;
+		}
+
+		mStats.OnAllocate(::End::Front, size, guard - size - mFrontTop - META_SIZE, 0, META_SIZE, newTop - mBegin);
+		mTrace.Record(TraceOp::Allocate, ::End::Front, size, alignment);
+		mFront = alignedAddress;
+		mFrontTop = newTop;
+		return reinterpret_cast<void*>(alignedAddress);
+	}
+
+	// The back stack grows downwards, so the guard page sits between the allocation and the previous back allocation
+	void* TryAllocateBackGuarded(size_t size, size_t alignment, AllocatorError& error)
+	{
+		size_t pageSize = mGrowth.GetPageSize();
+		uintptr_t guard = AlignDown(mBackTop, pageSize) - pageSize;
+		uintptr_t alignedAddress = 0;
+		if (guard <= mFrontTop || size >= guard - mFrontTop
+			|| (alignedAddress = AlignDown(guard - size, alignment)) <= mFrontTop + META_SIZE + CANARY_SIZE)
+		{
+			return Spill(::End::Back, size, alignment, AllocatorError::Overlap, error);
+		}
+
+		uintptr_t newTop = alignedAddress - META_SIZE - CANARY_SIZE;
+		if (!mGrowth.CommitBack(newTop) || !mGrowth.AddGuardPage(::End::Back, alignedAddress, guard))
+		{
+			return Spill(::End::Back, size, alignment, AllocatorError::CommitFailed, error);
+		}
+		HTL_UNPOISON_MEMORY(newTop, guard - newTop);
+
+		if (!mMeta.Write(::End::Back, alignedAddress, mBack, size))
+		{
+			mGrowth.ReleaseGuardPages(::End::Back, mBack);
+			error = AllocatorError::MetaDataFailed;
+			return nullptr;
+		}
+
+		mStats.OnAllocate(::End::Back, size, mBackTop - alignedAddress - size, 0, META_SIZE, mEnd - newTop);
+		mTrace.Record(TraceOp::Allocate, ::End::Back, size, alignment);
+		mBack = alignedAddress;
+		mBackTop = newTop;
+		return reinterpret_cast<void*>(alignedAddress);
+	}
+
+	// Out of memory, the fallback policy gets a chance before the reason is returned as error
+	HTL_COLD void* Spill(::End side, size_t size, size_t alignment, AllocatorError reason, AllocatorError& error)
+	{
+		void* memory = mFallback.Allocate(side, size, alignment);
+		if (!memory)
+		{
+			error = reason;
+			return nullptr;
+		}
+		mTrace.Record(TraceOp::Allocate, side, size, alignment);
+		return memory;
+	}
+
+	// Destructors run after the free is validated but before the block is released, the record of a spilled New lives inside it
+	// A stack which continues in chunks can't free its own allocations before the chunks are drained
+	HTL_COLD void FreeSpill(::End side, void* memory)
+	{
+		if (!mFallback.IsLast(side, memory))
+		{
+			ErrorPolicy::Assert(AllocatorError::NotLastAllocation, "Pointer doesn't match last allocated memory, couldn't free memory");
+			return;
+		}
+		DestroyObjectsOnFree(side, reinterpret_cast<uintptr_t>(memory));
+		mFallback.Free(side, memory);
+		mTrace.Record(TraceOp::Free, side, 0, 0);
+	}
+
+	HTL_COLD static void ReportAllocationError(::End side, AllocatorError error)
+	{
+		switch (error)
+		{
+		case AllocatorError::Overlap:
+			ErrorPolicy::Assert(error, side == ::End::Front ? "Front Stack overlaps with Back Stack!" : "Back Stack overlaps with Front Stack");
+			break;
+		case AllocatorError::CommitFailed:
+			ErrorPolicy::Assert(error, side == ::End::Front ? "Could not commit additional front page!" : "Could not commit additional end page");
+			break;
+		case AllocatorError::MetaDataFailed:
+			ErrorPolicy::Assert(error, "Could not store meta data");
+			break;
+		default:
+			ErrorPolicy::Assert(error, GetErrorName(error));
+			break;
+		}
+	}
+
+	// Power of 2 always has exactly 1 bit set in binary representation (for signed values)
+	static bool IsPowerOf2(size_t val)
+	{
+		return val > 0 && !(val & (val - 1));
+	}
+
+	// One branch on the common path, the detailed checks only run for invalid input
+	static bool CheckAllocateParameters(size_t size, size_t alignment)
+	{
+		if (HTL_UNLIKELY(size == 0 || !IsPowerOf2(alignment)))
+		{
+			ReportInvalidParameters(size, alignment);
+			return false;
+		}
+		return true;
+	}
+
+	static AllocatorError ValidateAllocateParameters(size_t size, size_t alignment)
+	{
+		if (!IsPowerOf2(alignment))
+		{
+			return AllocatorError::InvalidAlignment;
+		}
+		// Don't let the user allocate empty space
+		return size == 0 ? AllocatorError::InvalidSize : AllocatorError::None;
+	}
+
+	HTL_COLD static void ReportInvalidParameters(size_t size, size_t alignment)
+	{
+		if (!IsPowerOf2(alignment))
+		{
+			ErrorPolicy::Assert(AllocatorError::InvalidAlignment, "Alignment for allocate musst be a power of 2!");
+		}
+		if (size == 0)
+		{
+			ErrorPolicy::Assert(AllocatorError::InvalidSize, "Size to allocate is zero");
+		}
+	}
+
+	template<class T, class... Args>
+	T* Construct(::End side, size_t count, Args&&... args)
+	{
+		size_t totalSize = 0;
+		if (!GetArraySize(count, sizeof(T), alignof(T), totalSize))
+		{
+			return nullptr;
+		}
+
+		// The record follows the objects, so the allocation starts with the objects and is freed with their pointer
+		const bool withRecord = !std::is_trivially_destructible<T>::value;
+		size_t alignment = alignof(T);
+		size_t recordOffset = 0;
+		if (withRecord)
+		{
+			alignment = alignof(T) > alignof(DestructorRecord) ? alignof(T) : alignof(DestructorRecord);
+			recordOffset = AlignUp(totalSize, alignof(DestructorRecord));
+			if (recordOffset < totalSize || recordOffset > SIZE_MAX - sizeof(DestructorRecord))
+			{
+				ErrorPolicy::Assert(AllocatorError::InvalidSize, "Array size overflows");
+				return nullptr;
+			}
+			totalSize = recordOffset + sizeof(DestructorRecord);
+		}
+
+		void* memory = side == ::End::Front ? AllocateFrontUnchecked(totalSize, alignment) : AllocateBackUnchecked(totalSize, alignment);
+		if (!memory)
+		{
+			return nullptr;
+		}
+
+		// Arrays are value-initialized without arguments, so arguments are never forwarded twice
+		T* objects = static_cast<T*>(memory);
+		size_t constructed = 0;
+		try
+		{
+			for (; constructed < count; ++constructed)
+			{
+				new (objects + constructed) T(std::forward<Args>(args)...);
+			}
+		}
+		catch (...)
+		{
+			DestroyObjects<T>(objects, constructed);
+			// Without meta data the memory stays allocated until the next Reset or marker release
+			if (MetaDataPolicy::SUPPORTS_FREE && side == ::End::Front)
+			{
+				Free(memory);
+			}
+			else if (MetaDataPolicy::SUPPORTS_FREE)
+			{
+				FreeBack(memory);
+			}
+			throw;
+		}
+
+		if (withRecord)
+		{
+			DestructorRecord*& head = mDestructors[static_cast<int>(side)];
+			head = new (static_cast<char*>(memory) + recordOffset) DestructorRecord{ head, &DestroyObjects<T>, memory, count };
+		}
+		return objects;
+	}
+
+	template<class T>
+	static void DestroyObjects(void* objects, size_t count)
+	{
+		T* typed = static_cast<T*>(objects);
+		while (count > 0)
+		{
+			typed[--count].~T();
+		}
+	}
+
+	// Runs the destructors of a freed allocation if it was created by New, only called once the free was validated
+	void DestroyObjectsOnFree(::End side, uintptr_t memory)
+	{
+		DestructorRecord* head = mDestructors[static_cast<int>(side)];
+		if (HTL_UNLIKELY(head != nullptr) && reinterpret_cast<uintptr_t>(head->Objects) == memory)
+		{
+			DestroyObjectsTo(side, head->Previous);
+		}
+	}
+
+	// Runs all destructors of the stack which were recorded after stop, newest first
+	void DestroyObjectsTo(::End side, DestructorRecord* stop)
+	{
+		DestructorRecord*& head = mDestructors[static_cast<int>(side)];
+		while (head && head != stop)
+		{
+			DestructorRecord* record = head;
+			head = record->Previous;
+			record->Destroy(record->Objects, record->Count);
+		}
+	}
+
+	static bool GetArraySize(size_t count, size_t size, size_t alignment, size_t& totalSize)
+	{
+		if (!CheckAllocateParameters(size, alignment))
+		{
+			return false;
+		}
+		if (count == 0)
+		{
+			ErrorPolicy::Assert(AllocatorError::InvalidSize, "Element count to allocate is zero");
+			return false;
+		}
+		size_t stride = AlignUp(size, alignment);
+		if (stride < size || count - 1 > (SIZE_MAX - size) / stride)
+		{
+			ErrorPolicy::Assert(AllocatorError::InvalidSize, "Array size overflows");
+			return false;
+		}
+		totalSize = stride * (count - 1) + size;
+		return true;
+	}
+
+	// Blocks are laid out in order, every block starts at the next aligned offset after the previous one
+	static bool GetBatchSize(const size_t* sizes, size_t count, size_t alignment, size_t& totalSize)
+	{
+		// The block count is checked like a size, an empty batch is rejected like an empty allocation
+		if (!CheckAllocateParameters(count, alignment))
+		{
+			return false;
+		}
+		size_t offset = 0;
+		for (size_t i = 0; i < count; ++i)
+		{
+			if (sizes[i] == 0 || sizes[i] > SIZE_MAX - alignment - offset)
+			{
+				ErrorPolicy::Assert(AllocatorError::InvalidSize, "Invalid batch size, block is zero or batch size overflows");
+				return false;
+			}
+			offset = AlignUp(offset, alignment) + sizes[i];
+		}
+		totalSize = offset;
+		return true;
+	}
+
+	static void SplitBatch(void* group, const size_t* sizes, size_t count, size_t alignment, void** out)
+	{
+		uintptr_t address = reinterpret_cast<uintptr_t>(group);
+		for (size_t i = 0; i < count; ++i)
+		{
+			out[i] = group ? reinterpret_cast<void*>(address) : nullptr;
+			address = AlignUp(address + sizes[i], alignment);
+		}
+	}
+
+	// If canaries are not valid, we're not allowed to free, because something has overwritten them
+	static void CheckCanaries(uintptr_t alignedAddress, size_t size)
+	{
+		// Check begin canary
+		if (!BoundsCheckPolicy::IsCanaryValid(alignedAddress - META_SIZE - CANARY_SIZE))
+		{
+			ErrorPolicy::Assert(AllocatorError::CorruptedCanary, "Invalid Begin Canary");
+		}
+
+		// Check end canary
+		if (!BoundsCheckPolicy::IsCanaryValid(alignedAddress + size))
+		{
+			ErrorPolicy::Assert(AllocatorError::CorruptedCanary, "Invalid End Canary");
+		}
+	}
+
+	// Fallback of Reallocate for allocations which are not on top of their stack
+	// The size of the old allocation is found by walking the chain, which also verifies the pointer
+	void* ReallocateByCopy(::End side, void* memory, size_t newSize, size_t alignment)
+	{
+		void* newMemory = nullptr;
+		if (FallbackPolicy::ENABLED && mFallback.Reallocate(side, memory, newSize, alignment, newMemory))
+		{
+			mTrace.Record(TraceOp::Reallocate, side, newSize, alignment);
+			return newMemory;
+		}
+		if (!MetaDataPolicy::SUPPORTS_FREE)
+		{
+			ErrorPolicy::Assert(AllocatorError::Unsupported, "Reallocate of an allocation which is not on top is not supported without meta data");
+			return nullptr;
+		}
+
+		uintptr_t stackBase = side == ::End::Front ? mBegin : mEnd;
+		uintptr_t item = side == ::End::Front ? mFront : mBack;
+		size_t depth = 0;
+		while (item != reinterpret_cast<uintptr_t>(memory))
+		{
+			if (item == stackBase)
+			{
+				ErrorPolicy::Assert(AllocatorError::InvalidPointer, "Pointer is not an allocation of this stack, couldn't reallocate");
+				return nullptr;
+			}
+			item = mMeta.Read(side, item, depth++).LastItem;
+		}
+		size_t oldSize = mMeta.Read(side, item, depth).Size;
+
+		newMemory = side == ::End::Front ? Allocate(newSize, alignment) : AllocateBack(newSize, alignment);
+		if (newMemory)
+		{
+			memcpy(newMemory, memory, newSize < oldSize ? newSize : oldSize);
+		}
+		return newMemory;
+	}
+
+	// Walks the LastItem chain from top to marker and checks canaries of every allocation on the way
+	// Returns false if the marker isn't part of the chain (e.g. it points into the middle of an allocation)
+	bool CheckChainToMarker(::End side, uintptr_t top, uintptr_t marker, uintptr_t stackBase) const
+	{
+		if (!BoundsCheckPolicy::ENABLED || !MetaDataPolicy::SUPPORTS_FREE)
+		{
+			return true;
+		}
+
+		uintptr_t item = top;
+		size_t depth = 0;
+		while (item != marker)
+		{
+			if (item == stackBase)
+			{
+				ErrorPolicy::Assert(AllocatorError::InvalidPointer, "Marker is not part of the allocation chain, couldn't free memory");
+				return false;
+			}
+			MetaRecord record = mMeta.Read(side, item, depth++);
+			CheckCanaries(item, record.Size);
+			item = record.LastItem;
+		}
+		return true;
+	}
+
+	// First address after the front stack / first address of the back stack including canaries and meta data
+	uintptr_t GetFrontTop(uintptr_t front) const
+	{
+		if (front == mBegin)
+		{
+			return mBegin;
+		}
+		uintptr_t guardEnd = BoundsCheckPolicy::GUARD_THRESHOLD ? mGrowth.GetGuardEnd(::End::Front, front) : 0;
+		return guardEnd ? guardEnd : front + mMeta.Read(::End::Front, front).Size + CANARY_SIZE;
+	}
+
+	uintptr_t GetBackTop(uintptr_t back) const
+	{
+		return back == mEnd ? mEnd : back - META_SIZE - CANARY_SIZE;
+	}
+
+	// The front stack shrank from oldTop: poisons the released range for ASan, reopens the guard pages of freed
+	// allocations and decommits
+	void ReleaseFront(uintptr_t oldTop)
+	{
+		HTL_POISON_MEMORY(mFrontTop, oldTop - mFrontTop);
+		if (BoundsCheckPolicy::GUARD_THRESHOLD)
+		{
+			mGrowth.ReleaseGuardPages(::End::Front, mFront);
+		}
+		DecommitFrontPages();
+	}
+
+	void ReleaseBack(uintptr_t oldTop)
+	{
+		HTL_POISON_MEMORY(oldTop, mBackTop - oldTop);
+		if (BoundsCheckPolicy::GUARD_THRESHOLD)
+		{
+			mGrowth.ReleaseGuardPages(::End::Back, mBack);
+		}
+		DecommitBackPages();
+	}
+
+	void DecommitFrontPages(void)
+	{
+		if (!mGrowth.DecommitFront(mBegin, mFrontTop))
+		{
+			ErrorPolicy::Report(AllocatorError::DecommitFailed, "Could not decommit front pages");
+		}
+	}
+
+	void DecommitBackPages(void)
+	{
+		if (!mGrowth.DecommitBack(mEnd, mBackTop))
+		{
+			ErrorPolicy::Report(AllocatorError::DecommitFailed, "Could not decommit back pages");
+		}
+	}
+
+	// Check for possible pointer errors
+	void ValidateMemoryPointer(uintptr_t memory) const
+	{
+		if (reinterpret_cast<void*>(memory) == nullptr)
+		{
+			ErrorPolicy::Assert(AllocatorError::InvalidPointer, "Invalid Pointer, couldn't free memory");
+		}
+		else if (memory < mBegin || memory > mEnd)
+		{
+			ErrorPolicy::Assert(AllocatorError::InvalidPointer, "Pointer not in range of reserved space, couldn't free memory");
+		}
+	}
+
+	// Alignment is always a power of 2, so the adjustment is a mask instead of a modulo
+	static uintptr_t AlignUp(uintptr_t address, size_t alignment)
+	{
+		return (address + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+	}
+
+	static uintptr_t AlignDown(uintptr_t address, size_t alignment)
+	{
+		return address & ~(static_cast<uintptr_t>(alignment) - 1);
+	}
+
+	// Checks the record of the last allocation of a stack before it is trusted: LastItem has to point into the stack
+	// behind the allocation, and the allocation has to end at the front top (exactly, unless it has a guard page)
+	// or before the previous back allocation
+	bool ValidateMetaRecord(::End side, uintptr_t address, const MetaRecord& record) const
+	{
+		if (side == ::End::Front)
+		{
+			if (record.LastItem < mBegin || (record.LastItem != mBegin && record.LastItem > address - META_SIZE - 2 * CANARY_SIZE))
+			{
+				return false;
+			}
+			uintptr_t end = address + record.Size + CANARY_SIZE;
+			return end >= address && (BoundsCheckPolicy::GUARD_THRESHOLD ? end <= mFrontTop : end == mFrontTop);
+		}
+
+		if (record.LastItem > mEnd || (record.LastItem != mEnd && record.LastItem < address + META_SIZE + 2 * CANARY_SIZE))
+		{
+			return false;
+		}
+		uintptr_t previousTop = GetBackTop(record.LastItem);
+		return record.Size <= previousTop - address && address + record.Size + CANARY_SIZE <= previousTop;
+	}
+
+	// Returns true if the memory was freed
+	bool FreeMemoryAndUpdatePointer(::End side, uintptr_t pointerToFree, uintptr_t& pointerToUpdate)
+	{
+		if (!MetaDataPolicy::SUPPORTS_FREE)
+		{
+			ErrorPolicy::Assert(AllocatorError::Unsupported, "Free is not supported without meta data, use markers or Reset");
+			return false;
+		}
+
+		// LIFO check
+		if (pointerToFree != pointerToUpdate)
+		{
+			ValidateMemoryPointer(pointerToFree);
+			ErrorPolicy::Assert(AllocatorError::NotLastAllocation, "Pointer doesn't match last allocated memory, couldn't free memory");
+			return false;
+		}
+
+		MetaRecord currentMetadata = mMeta.Read(side, pointerToFree);
+		if (MetaDataPolicy::VERIFIES && HTL_UNLIKELY(!ValidateMetaRecord(side, pointerToFree, currentMetadata)))
+		{
+			ErrorPolicy::Assert(AllocatorError::CorruptedMetaData, "Meta data of the allocation is corrupted, couldn't free memory");
+			return false;
+		}
+
+		if (BoundsCheckPolicy::ENABLED)
+		{
+			CheckCanaries(pointerToFree, currentMetadata.Size);
+		}
+
+		// We don't care what the user has written in the memory, therefore we just set the pointer to LastItem and "ignore" the previously allocated memory
+		mMeta.Pop(side);
+		pointerToUpdate = currentMetadata.LastItem;
+		return true;
+	}
+
+	static const ptrdiff_t CANARY_SIZE = BoundsCheckPolicy::CANARY_SIZE;
+	static const ptrdiff_t META_SIZE = MetaDataPolicy::META_SIZE;
+
+	// Boundaries of our allocation
+	uintptr_t mBegin = 0;
+	uintptr_t mEnd = 0;
+
+	// Decision: (A) using pointer to next/prev free memory or (B) points to user space begin
+	// --> (B) because this makes the LIFO check easier
+	uintptr_t mFront = 0;
+	uintptr_t mBack = 0;
+
+	// Additionally we keep the first free address of each stack, so allocating doesn't need to read the last meta data
+	// and works without any meta data at all
+	uintptr_t mFrontTop = 0;
+	uintptr_t mBackTop = 0;
+
+	// Heads of the destructor chains of New/NewArray, indexed by End
+	DestructorRecord* mDestructors[2] = {};
+
+	MetaDataPolicy mMeta;
+	GrowthPolicy mGrowth;
+	StatsPolicy mStats;
+	TracePolicy mTrace;
+	FallbackPolicy mFallback;
+};
+
+// The default allocator is configured with the defines after namespace Tests
+#if WITH_DEBUG_CANARIES
+using DefaultBoundsCheckPolicy = CanaryBoundsCheck;
+#else
+using DefaultBoundsCheckPolicy = NoBoundsCheck;
+#endif // WITH_DEBUG_CANARIES
+
+#if HTL_ALLOW_GROW
+using DefaultGrowthPolicy = VirtualMemoryGrowth;
+#else
+using DefaultGrowthPolicy = MallocGrowth;
+#endif // HTL_ALLOW_GROW
+
+#if _DEBUG
+using DefaultErrorPolicy = AssertErrors;
+#elif HTL_PRINT_ERRORS
+using DefaultErrorPolicy = HandlerErrors;
+#else
+using DefaultErrorPolicy = IgnoreErrors;
+#endif
+
+#if HTL_WITH_STATS
+using DefaultStatsPolicy = CollectStats;
+#else
+using DefaultStatsPolicy = NoStats;
+#endif // HTL_WITH_STATS
+
+#if HTL_WITH_TRACE
+using DefaultTracePolicy = RingBufferTrace;
+#else
+using DefaultTracePolicy = NoTrace;
+#endif // HTL_WITH_TRACE
+
+using DoubleEndedStackAllocator = DoubleEndedStackAllocatorT<DefaultBoundsCheckPolicy, InlineMetaData, DefaultGrowthPolicy, DefaultErrorPolicy, DefaultStatsPolicy, DefaultTracePolicy>;
+
+// Header-less configuration which still supports Free, records are kept in side tables
+using PackedStackAllocator = DoubleEndedStackAllocatorT<DefaultBoundsCheckPolicy, SideTableMetaData, DefaultGrowthPolicy, DefaultErrorPolicy, DefaultStatsPolicy, DefaultTracePolicy>;
+
+// Lean configuration for per-frame arenas: allocating is a plain pointer bump without any header bytes
+// Memory is released with markers or Reset only
+using FrameArenaAllocator = DoubleEndedStackAllocatorT<NoBoundsCheck, NoMetaData, VirtualMemoryGrowth, IgnoreErrors>;
+
+// Production hardening: 8 byte headers which are verified on every free, corruption is reported instead of followed
+// The header is the whole overhead per allocation (plus alignment padding), the verification replaces canaries
+using HardenedStackAllocator = DoubleEndedStackAllocatorT<NoBoundsCheck, CompactMetaData, DefaultGrowthPolicy, DefaultErrorPolicy, DefaultStatsPolicy, DefaultTracePolicy>;
+
+// Segmented growth: construct it with a small realMaxSize, further chunks are only reserved when it is exhausted
+using SegmentedStackAllocator = DoubleEndedStackAllocatorT<DefaultBoundsCheckPolicy, InlineMetaData, DefaultGrowthPolicy, DefaultErrorPolicy, DefaultStatsPolicy, DefaultTracePolicy, ChainedFallback<DefaultGrowthPolicy>>;
+
+// Never runs out of memory: allocations which don't fit anymore are spilled to the heap until the next Reset
+using SpillingStackAllocator = DoubleEndedStackAllocatorT<DefaultBoundsCheckPolicy, InlineMetaData, DefaultGrowthPolicy, DefaultErrorPolicy, DefaultStatsPolicy, DefaultTracePolicy, HeapFallback>;
+
+// RAII guard which takes a marker on construction and releases everything allocated on that stack afterwards on destruction
+template<class Allocator, End Side>
+class ScopedFrame
+{
+public:
+	explicit ScopedFrame(Allocator& allocator)
+		: mAllocator(allocator)
+		, mMarker(Side == End::Front ? allocator.GetFrontMarker() : allocator.GetBackMarker())
+	{
+	}
+
+	~ScopedFrame(void)
+	{
+		mAllocator.FreeToMarker(mMarker);
+	}
+
+private:
+	ScopedFrame(const ScopedFrame&) = delete;
+	ScopedFrame& operator = (const ScopedFrame&) = delete;
+
+	Allocator& mAllocator;
+	typename Allocator::Marker mMarker;
+};
+
+using ScopedFrontFrame = ScopedFrame<DoubleEndedStackAllocator, End::Front>;
+using ScopedBackFrame = ScopedFrame<DoubleEndedStackAllocator, End::Back>;
+
+// STL allocator on one stack of an allocator, e.g. for scratch containers which are thrown away with Reset or a marker
+// Deallocations which don't hit the top of the stack are deferred until the stack is reset
+// Throws bad_alloc like std::allocator if the stack is full
+template<class T, class Allocator, End Side>
+class StackAllocatorAdapterT
+{
+public:
+	using value_type = T;
+
+	template<class U>
+	struct rebind
+	{
+		using other = StackAllocatorAdapterT<U, Allocator, Side>;
+	};
+
+	explicit StackAllocatorAdapterT(Allocator& allocator) noexcept
+		: mAllocator(&allocator)
+	{
+	}
+
+	template<class U>
+	StackAllocatorAdapterT(const StackAllocatorAdapterT<U, Allocator, Side>& other) noexcept
+		: mAllocator(other.GetAllocator())
+	{
+	}
+
+	T* allocate(size_t count)
+	{
+		if (count > SIZE_MAX / sizeof(T))
+		{
+			throw std::bad_alloc();
+		}
+		// Allocators may be asked for zero elements, the stack doesn't allow empty allocations
+		size_t size = count ? count * sizeof(T) : 1;
+		void* memory = Side == End::Front ? mAllocator->Allocate(size, alignof(T)) : mAllocator->AllocateBack(size, alignof(T));
+		if (!memory)
+		{
+			throw std::bad_alloc();
+		}
+		return static_cast<T*>(memory);
+	}
+
+	void deallocate(T* memory, size_t) noexcept
+	{
+		if (Side == End::Front)
+		{
+			mAllocator->TryFree(memory);
+		}
+		else
+		{
+			mAllocator->TryFreeBack(memory);
+		}
+	}
+
+	Allocator* GetAllocator(void) const
+	{
+		return mAllocator;
+	}
+
+private:
+	Allocator* mAllocator;
+};
+
+template<class T, class U, class Allocator, End Side>
+bool operator == (const StackAllocatorAdapterT<T, Allocator, Side>& lhs, const StackAllocatorAdapterT<U, Allocator, Side>& rhs)
+{
+	return lhs.GetAllocator() == rhs.GetAllocator();
+}
+
+template<class T, class U, class Allocator, End Side>
+bool operator != (const StackAllocatorAdapterT<T, Allocator, Side>& lhs, const StackAllocatorAdapterT<U, Allocator, Side>& rhs)
+{
+	return !(lhs == rhs);
+}
+
+template<class T, End Side = End::Front>
+using StackAllocatorAdapter = StackAllocatorAdapterT<T, DoubleEndedStackAllocator, Side>;
+
+#if HTL_HAS_PMR
+// std::pmr::memory_resource on one stack of an allocator, same deferred deallocation rules as StackAllocatorAdapterT
+template<class Allocator, End Side>
+class StackMemoryResourceT : public std::pmr::memory_resource
+{
+public:
+	explicit StackMemoryResourceT(Allocator& allocator)
+		: mAllocator(allocator)
+	{
+	}
+
+	Allocator& GetAllocator(void) const
+	{
+		return mAllocator;
+	}
+
+protected:
+	void* do_allocate(size_t bytes, size_t alignment) override
+	{
+		size_t size = bytes ? bytes : 1;
+		void* memory = Side == End::Front ? mAllocator.Allocate(size, alignment) : mAllocator.AllocateBack(size, alignment);
+		if (!memory)
+		{
+			throw std::bad_alloc();
+		}
+		return memory;
+	}
+
+	void do_deallocate(void* memory, size_t, size_t) override
+	{
+		if (Side == End::Front)
+		{
+			mAllocator.TryFree(memory);
+		}
+		else
+		{
+			mAllocator.TryFreeBack(memory);
+		}
+	}
+
+	bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+	{
+		return this == &other;
+	}
+
+private:
+	StackMemoryResourceT(const StackMemoryResourceT&) = delete;
+	StackMemoryResourceT& operator = (const StackMemoryResourceT&) = delete;
+
+	Allocator& mAllocator;
+};
+
+using FrontStackMemoryResource = StackMemoryResourceT<DoubleEndedStackAllocator, End::Front>;
+using BackStackMemoryResource = StackMemoryResourceT<DoubleEndedStackAllocator, End::Back>;
+#endif // HTL_HAS_PMR
+
+/**
+* Lock-free variant for producer phases where many threads fill one shared arena
+* Both tops are stored as 32 bit offsets in one atomic word, so a single CAS sees and updates front and back together
+* -> a front and a back allocation can't both pass their overlap check against an outdated top of the other stack
+* There are no canaries or meta data and individual allocations can't be freed, only Reset releases memory
+**/
+template<class ErrorPolicy>
+class ConcurrentDoubleEndedStackAllocatorT
+{
+public:
+	static const size_t MAX_SIZE = UINT32_MAX;
+
+	// Ctor throws bad alloc exception if not enough memory is available or max_size doesn't fit into 32 bit offsets
+	explicit ConcurrentDoubleEndedStackAllocatorT(size_t max_size)
+	{
+		void* begin = max_size <= MAX_SIZE ? malloc(max_size) : nullptr;
+		if (!begin)
+		{
+			ErrorPolicy::Report(AllocatorError::ConstructionFailed, "Not enough memory to construct!");
+			throw std::bad_alloc();
+		}
+
+		mBegin = reinterpret_cast<uintptr_t>(begin);
+		mEnd = mBegin + max_size;
+		Reset();
+	}
+
+	~ConcurrentDoubleEndedStackAllocatorT(void)
+	{
+		free(reinterpret_cast<void*>(mBegin));
+	}
+
+	// Thread safe, returns nullptr if the stacks would overlap or input params are invalid
+	void* Allocate(size_t size, size_t alignment)
+	{
+		if (!CheckAllocateParameters(size, alignment))
+		{
+			return nullptr;
+		}
+
+		// Relaxed is enough, the CAS only has to hand out disjoint ranges and doesn't publish any data
+		uint64_t tops = mTops.load(std::memory_order_relaxed);
+		uintptr_t alignedAddress = 0;
+		uint64_t newTops = 0;
+		do
+		{
+			uintptr_t front = mBegin + GetFrontOffset(tops);
+			uintptr_t back = mBegin + GetBackOffset(tops);
+			alignedAddress = AlignUp(front, alignment);
+			if (alignedAddress > back || size > back - alignedAddress)
+			{
+				ErrorPolicy::Assert(AllocatorError::Overlap, "Front Stack overlaps with Back Stack!");
+				return nullptr;
+			}
+			newTops = Pack(alignedAddress + size - mBegin, GetBackOffset(tops));
+		} while (!mTops.compare_exchange_weak(tops, newTops, std::memory_order_relaxed));
+
+		return reinterpret_cast<void*>(alignedAddress);
+	}
+
+	void* AllocateBack(size_t size, size_t alignment)
+	{
+		if (!CheckAllocateParameters(size, alignment))
+		{
+			return nullptr;
+		}
+
+		uint64_t tops = mTops.load(std::memory_order_relaxed);
+		uintptr_t alignedAddress = 0;
+		uint64_t newTops = 0;
+		do
+		{
+			uintptr_t front = mBegin + GetFrontOffset(tops);
+			uintptr_t back = mBegin + GetBackOffset(tops);
+			if (size > back - front || (alignedAddress = AlignDown(back - size, alignment)) < front)
+			{
+				ErrorPolicy::Assert(AllocatorError::Overlap, "Back Stack overlaps with Front Stack");
+				return nullptr;
+			}
+			newTops = Pack(GetFrontOffset(tops), alignedAddress - mBegin);
+		} while (!mTops.compare_exchange_weak(tops, newTops, std::memory_order_relaxed));
+
+		return reinterpret_cast<void*>(alignedAddress);
+	}
+
+	// Not thread safe, all allocating threads have to be done (e.g. joined) before
+	void Reset(void)
+	{
+		mTops.store(Pack(0, mEnd - mBegin), std::memory_order_relaxed);
+	}
+
+	// Needed for testing
+	const void* Begin()
+	{
+		return reinterpret_cast<void*>(mBegin);
+	}
+
+	const void* End()
+	{
+		return reinterpret_cast<void*>(mEnd);
+	}
+
+	size_t GetUsedSize(void) const
+	{
+		uint64_t tops = mTops.load(std::memory_order_relaxed);
+		return GetFrontOffset(tops) + (mEnd - mBegin - GetBackOffset(tops));
+	}
+
+private:
+	ConcurrentDoubleEndedStackAllocatorT(const ConcurrentDoubleEndedStackAllocatorT&) = delete;
+	ConcurrentDoubleEndedStackAllocatorT& operator = (const ConcurrentDoubleEndedStackAllocatorT&) = delete;
+
+	static uint64_t Pack(uint64_t frontOffset, uint64_t backOffset)
+	{
+		return frontOffset | (backOffset << 32);
+	}
+
+	static uintptr_t GetFrontOffset(uint64_t tops)
+	{
+		return static_cast<uintptr_t>(tops & UINT32_MAX);
+	}
+
+	static uintptr_t GetBackOffset(uint64_t tops)
+	{
+		return static_cast<uintptr_t>(tops >> 32);
+	}
+
+	static bool CheckAllocateParameters(size_t size, size_t alignment)
+	{
+		bool ret = true;
+		if (alignment == 0 || (alignment & (alignment - 1)))
+		{
+			ret = false;
+			ErrorPolicy::Assert(AllocatorError::InvalidAlignment, "Alignment for allocate musst be a power of 2!");
+		}
+		// Don't let the user allocate empty space
+		if (size == 0)
+		{
+			ret = false;
+			ErrorPolicy::Assert(AllocatorError::InvalidSize, "Size to allocate is zero");
+		}
+		return ret;
+	}
+
+	static uintptr_t AlignUp(uintptr_t address, size_t alignment)
+	{
+		return (address + alignment - 1) & ~(alignment - 1);
+	}
+
+	static uintptr_t AlignDown(uintptr_t address, size_t alignment)
+	{
+		return address & ~(alignment - 1);
+	}
+
+	uintptr_t mBegin = 0;
+	uintptr_t mEnd = 0;
+
+	// Lower 32 bit: offset of the first free address after the front stack
+	// Upper 32 bit: offset of the first used address of the back stack
+	std::atomic<uint64_t> mTops;
+};
+
+using ConcurrentDoubleEndedStackAllocator = ConcurrentDoubleEndedStackAllocatorT<DefaultErrorPolicy>;
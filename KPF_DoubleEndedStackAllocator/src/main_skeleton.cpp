@@ -3,13 +3,23 @@
 * Group members: Handl Anja (gs20m005), Tributsch Harald (gs20m008), Leithner Michael (gs20m012)
 * 
 * This exercise supports a growable and non-growable Double Ended Stack (see Defines)
+* The allocator lives in DoubleEndedStackAllocator.h, this file contains our tests
 * Compilation of this File was testet with C++14 (as VS 2019 doesn't support older standards by default)
 * Parts of the code can be enabled/disabled by using the defines after namespace Tests
 **/
 
-#include <cassert>
+#include <atomic>
+#include <cstring>
 #include <iostream>
-#include <malloc.h>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <csignal>
+#include <sys/wait.h>
+#endif
 
 // Color defines for test output
 #define ANSI_COLOR_RED     "\x1b[31m"
@@ -54,521 +64,11 @@ namespace Tests
 #define HTL_ALLOW_GROW			1	// Enables/Disables growing by using virtual memory
 #define HTL_PRINT_ERRORS		1	// Enables/Disables Printing of error outputs
 #define HTL_RUN_CUSTOM_TESTS	1	// Enables/Disables Our own tests
+#define HTL_WITH_STATS			0	// Enables/Disables collecting usage statistics
+#define HTL_WITH_TRACE			0	// Enables/Disables recording allocations into a trace ring buffer
 #define HTL_WITH_DEBUG_OUTPUT	0	// Enables/Disables Debug output from us
 
-
-#if HTL_ALLOW_GROW
-#include<windows.h>
-#endif
-
-// Define Custom output for cleaner code
-#if HTL_WITH_DEBUG_OUTPUT
-#define HTL_DEBUG(...) \
-	printf("[INFO]: "); \
-	printf(__VA_ARGS__); \
-	printf("\n");
-#else
-#define HTL_DEBUG(...)
-#endif
-#if HTL_PRINT_ERRORS
-#define HTL_ERROR(...) \
-	printf(ANSI_COLOR_RED "[Error]" ANSI_COLOR_RESET ": "); \
-	printf(__VA_ARGS__); \
-	printf("\n");
-#else
-#define HTL_ERROR(...)
-#endif
-
-// Define custom assert depending on build configuration
-// in debug mode -> just use standard assert
-// in release -> print formal message to user
-#if _DEBUG
-#define HTL_ASSERT(expr) \
-	assert(!expr);
-#else
-#define HTL_ASSERT(expr) \
-	HTL_ERROR(expr);
-#endif
-
-/**
-* You work on your DoubleEndedStackAllocator. Stick to the provided interface, this is
-* necessary for testing your assignment in the end. Don't remove or rename the public
-* interface of the allocator. Also don't add any additional initialization code, the
-* allocator needs to work after it was created and its constructor was called. You can
-* add additional public functions but those should only be used for your own testing.
-**/
-class DoubleEndedStackAllocator
-{
-public:
-#if HTL_ALLOW_GROW
-	// Ctor throws bad alloc exception if not enough memory is available
-	// --> otherwise we would need to either the object as "not usable" and try to reserve memory at alloc calls
-	// Using default param realMaxSize to be able to reserve a given amount of virtual memory for testing
-	// Growing allocator ignores max_size and reserves an internally specified size to allow resizing further inizial allocated size
-	DoubleEndedStackAllocator(size_t max_size, size_t realMaxSize = DEFAULT_ALLOC_SIZE)
-#else
-	DoubleEndedStackAllocator(size_t max_size)
-#endif // HTL_ALLOW_GROW
-	{
-		// Ensure we are working on fitting size types
-		static_assert(sizeof(size_t) == sizeof(uintptr_t), "Size mismatch of size_t and uintptr_t");
-
-#if HTL_ALLOW_GROW
-		// Normally we would reserve a big chunk of virtual memory (defined as DEFAULT_ALLOC_SIZE) to allow internal grow
-		// but if the user requests more memory, we need to support it
-		if (max_size > realMaxSize)
-		{
-			realMaxSize = max_size;
-		}
-
-		// Reserve memory and init pointers
-		SYSTEM_INFO si;
-		GetSystemInfo(&si);
-		mPageSize = si.dwPageSize;
-		//HTL_DEBUG("page size: %u bytes, allocation granularity: %u", mPageSize, si.dwAllocationGranularity);
-		// -> PageSize 4096 bytes, allocation granularity 65536
-
-		// First reserve memory from virtual space, using PAGE_NOACCESS for no access protection until pages are commited
-		void* begin = VirtualAlloc(NULL, realMaxSize, MEM_RESERVE, PAGE_NOACCESS);
-		if (!begin)
-		{
-			HTL_ERROR("Not enough virtual memory to construct!");
-			throw std::bad_alloc();
-		}
-
-		HTL_DEBUG("Reserved virtual memory from [%llx] to [%llx] for size %zu", reinterpret_cast<uintptr_t>(begin), (reinterpret_cast<uintptr_t>(begin) + realMaxSize), realMaxSize);
-
-		// Then commit a page of space for front...
-		begin = VirtualAlloc(begin, mPageSize, MEM_COMMIT, PAGE_READWRITE);
-		if (!begin)
-		{
-			HTL_ERROR("Could not commit begin page");
-			throw std::bad_alloc();
-		}
-		mBegin = mFront = reinterpret_cast<uintptr_t>(begin);
-		mPageEnd = mFront + mPageSize;
-
-		HTL_DEBUG("mPageEnd   [%llx]", mPageEnd);
-
-		// ...and for back
-		begin = VirtualAlloc(reinterpret_cast<void*>(mBegin + realMaxSize - mPageSize), mPageSize, MEM_COMMIT, PAGE_READWRITE);
-		if (!begin)
-		{
-			HTL_ERROR("Could not commit end page");
-			throw std::bad_alloc();
-		}
-		mPageStart = reinterpret_cast<uintptr_t>(begin);
-		mEnd = mBack = mPageStart + mPageSize;
-
-		HTL_DEBUG("mPageStart [%llx]", mPageStart);
-
-#else
-		// Reserve memory and init pointers
-		void* begin = malloc(max_size);
-		if (!begin)
-		{
-			HTL_ERROR("Not enough stack memory to construct!");
-			throw std::bad_alloc();
-		}
-
-		mBegin = mFront = reinterpret_cast<uintptr_t>(begin);
-		mEnd = mBack = mBegin + max_size;
-
-		HTL_DEBUG("constructed allocator from [%llx] to [%llx]", mBegin, mEnd);
-		HTL_DEBUG("size: [%zu]", max_size);
-		HTL_DEBUG("diff: [%llu]", mEnd - mBegin);
-#endif // HTL_ALLOW_GROW
-	}
-
-	~DoubleEndedStackAllocator(void)
-	{
-		Reset();
-
-		// Release reserved memory back to system
-		void* begin = reinterpret_cast<void*>(mBegin);
-		if (begin)
-		{
-#if HTL_ALLOW_GROW
-			VirtualFree(begin, 0, MEM_RELEASE);
-#else
-			free(begin);
-#endif // HTL_ALLOW_GROW
-		}
-	}
-
-	// Allocate given amount of memory with alignment
-	// If there is not enough memory left or input params are invalid -> assert and returns a nullptr
-	void* Allocate(size_t size, size_t alignment)
-	{
-		if (!CheckAllocateParameters(size, alignment))
-		{
-			return nullptr;
-		}
-
-		uintptr_t lastItem = mFront;
-		uintptr_t newFront = mFront;
-
-		// Jump to next free address -> if Front == Begin -> Front is free address
-		if (mFront != mBegin)
-		{
-			MetaData* meta = GetMetaData(mFront);
-			newFront = mFront + meta->Size + CANARY_SIZE;
-		}
-
-		// Search for aligned address with offset for canary and meta
-		uintptr_t alignedAddress = AlignUp(newFront + CANARY_SIZE + META_SIZE, alignment);
-
-#if HTL_ALLOW_GROW
-		// Commit additional space if necessary
-		while ((alignedAddress + size + CANARY_SIZE) > mPageEnd)
-		{
-			void* begin = VirtualAlloc(reinterpret_cast<void*>(mPageEnd), mPageSize, MEM_COMMIT, PAGE_READWRITE);
-			if (!begin)
-			{
-				HTL_ASSERT("Could not commit additional front page!")
-				return nullptr;
-			}
-			mPageEnd += mPageSize;
-
-			HTL_DEBUG("Commited new Page Front   [%llx]", mPageEnd);
-		}
-#endif // HTL_ALLOW_GROW
-
-		// Check if front allocation would overlap with back allocation
-		bool overlap = false;
-		if (mBack == mEnd)
-		{
-			// In this case, there are no back allocations -> more space for front
-			overlap |= (alignedAddress + size + CANARY_SIZE) >= mBack;
-		}
-		else
-		{
-			overlap |= (alignedAddress + size + CANARY_SIZE) >= (mBack - META_SIZE - CANARY_SIZE);
-		}
-
-		if (overlap)
-		{
-			HTL_ASSERT("Front Stack overlaps with Back Stack!")
-			return nullptr;
-		}
-
-		mFront = alignedAddress;
-
-#if WITH_DEBUG_CANARIES
-		WriteBeginCanary(alignedAddress);
-		WriteEndCanary(alignedAddress, size);
-#endif // WITH_DEBUG_CANARIES
-		WriteMeta(alignedAddress, lastItem, size);
-
-		return reinterpret_cast<void*>(mFront);
-	}
-
-	void* AllocateBack(size_t size, size_t alignment)
-	{
-		if (!CheckAllocateParameters(size, alignment))
-		{
-			return nullptr;
-		}
-
-		uintptr_t lastItem = mBack;
-		uintptr_t newBack = mBack - size - CANARY_SIZE;
-
-		// Jump to next free address -> if Back == End -> Back is free address
-		if (mEnd != mBack)
-		{
-			newBack = mBack - META_SIZE - 2 * CANARY_SIZE - size;
-		}
-
-		uintptr_t alignedAddress = AlignDown(newBack, alignment);
-
-#if HTL_ALLOW_GROW
-		// Commit additional space if necessary
-		while ((alignedAddress - META_SIZE - CANARY_SIZE) < mPageStart)
-		{
-			void* begin = VirtualAlloc(reinterpret_cast<void*>(mPageStart - mPageSize), mPageSize, MEM_COMMIT, PAGE_READWRITE);
-			if (!begin)
-			{
-				HTL_ASSERT("Could not commit additional end page")
-				return nullptr;
-			}
-			mPageStart = mPageStart - mPageSize;
-
-			HTL_DEBUG("Commited new PageBack     [%llx]", mPageStart);
-		}
-#endif // HTL_ALLOW_GROW
-
-		// Check if back allocation would overlap with front allocation
-		bool overlap = false;
-		if (mFront == mBegin)
-		{
-			// In this case, there are no front allocations -> more space for back
-			overlap |= alignedAddress - META_SIZE - CANARY_SIZE <= mFront;
-		}
-		else
-		{
-			overlap |= (alignedAddress - META_SIZE - CANARY_SIZE) <= (mFront + GetMetaData(mFront)->Size + CANARY_SIZE);
-		}
-
-		if (overlap)
-		{
-			HTL_ASSERT("Back Stack overlaps with Front Stack")
-			return nullptr;
-		}
-
-		mBack = alignedAddress;
-
-#if WITH_DEBUG_CANARIES
-		WriteBeginCanary(alignedAddress);
-		WriteEndCanary(alignedAddress, size);
-#endif // WITH_DEBUG_CANARIES
-		WriteMeta(alignedAddress, lastItem, size);
-
-		return reinterpret_cast<void*>(mBack);
-	}
-
-	// Free previously allocated memory
-	// Does nothing if provided address does not fit last allocation (LIFO requirement)
-	// Asserts if detects overwritten canaries if WITH_DEBUG_CANARIES is enabled
-	void Free(void* memory)
-	{
-		if (mFront != mBegin)
-		{
-			FreeMemoryAndUpdatePointer(reinterpret_cast<uintptr_t>(memory), mFront);
-		}
-	}
-
-	void FreeBack(void* memory)
-	{
-		if (mBack != mEnd)
-		{
-			FreeMemoryAndUpdatePointer(reinterpret_cast<uintptr_t>(memory), mBack);
-		}
-	}
-
-	void Reset(void)
-	{
-		while (mFront != mBegin)
-		{
-			Free(reinterpret_cast<void*>(mFront));
-		}
-
-		while (mBack != mEnd)
-		{
-			FreeBack(reinterpret_cast<void*>(mBack));
-		}
-
-		// Just setting internal pointers would be faster, but would skip pointer and canary validation
-		// mFront = mBegin;
-		// mBack = mEnd;
-	}
-
-	// Needed for testing
-	const void* Begin()
-	{
-		return reinterpret_cast<void*>(mBegin);
-	}
-
-	const void* Front()
-	{
-		return reinterpret_cast<void*>(mFront);
-	}
-
-	const void* End()
-	{
-		return reinterpret_cast<void*>(mEnd);
-	}
-
-	const void* Back()
-	{
-		return reinterpret_cast<void*>(mBack);
-	}
-
-	static size_t GetCanaraySize()
-	{
-		return CANARY_SIZE;
-	}
-
-	static size_t GetMetaSize()
-	{
-		return META_SIZE;
-	}
-
-private:
-	// Because no interface was given and the auto-generated default copy/move ctor would cause problems
-	// We either have to implement our own custom functionality or remove them
-	// -> We decided to prevent copy and move because in this context to us it does not make much sense
-	// to copy or move a created allocator and we didn't want to crack our heads on errors, undefined behavior
-	// or the usage of an internal mapping table to support invalidated pointers
-	DoubleEndedStackAllocator(const DoubleEndedStackAllocator&) = delete;
-	DoubleEndedStackAllocator& operator = (const DoubleEndedStackAllocator&) = delete;
-	DoubleEndedStackAllocator(const DoubleEndedStackAllocator&&) = delete;
-	DoubleEndedStackAllocator& operator = (const DoubleEndedStackAllocator&&) = delete;
-
-	// Power of 2 always has exactly 1 bit set in binary representation (for signed values)
-	static bool IsPowerOf2(size_t val)
-	{
-		return val > 0 && !(val & (val - 1));
-	}
-
-	static bool CheckAllocateParameters(size_t size, size_t alignment)
-	{
-		bool ret = true;
-		if (!IsPowerOf2(alignment))
-		{
-			ret = false;
-			HTL_ASSERT("Alignment for allocate musst be a power of 2!")
-		}
-		// Don't let the user allocate empty space
-		if (size == 0)
-		{
-			ret = false;
-			HTL_ASSERT("Size to allocate is zero");
-		}
-		return ret;
-	}
-
-#if WITH_DEBUG_CANARIES
-	static void WriteBeginCanary(uintptr_t alignedAddress)
-	{
-		uintptr_t canaryAddress = alignedAddress - META_SIZE - CANARY_SIZE;
-		//HTL_DEBUG("Begin canaryAddress: [%llx]", canaryAddress);
-		*reinterpret_cast<uint32_t*>(canaryAddress) = CANARY;
-	}
-
-	static void WriteEndCanary(uintptr_t alignedAddress, size_t size)
-	{
-		uintptr_t canaryAddress = alignedAddress + size;
-		//HTL_DEBUG("End canaryAddress: [%llx]", canaryAddress);
-		*reinterpret_cast<uint32_t*>(canaryAddress) = CANARY;
-	}
-
-	// If canaries are not valid, we're not allowed to free, because something has overwritten them
-	static void CheckCanaries(uintptr_t alignedAddress, size_t size)
-	{
-		// Check begin canary
-		uintptr_t canaryAddress = alignedAddress - META_SIZE - CANARY_SIZE;
-		if (*reinterpret_cast<uint32_t*>(canaryAddress) != CANARY)
-		{
-			HTL_ASSERT("Invalid Begin Canary")
-		}
-
-		// Check end canary
-		canaryAddress = alignedAddress + size;
-		if (*reinterpret_cast<uint32_t*>(canaryAddress) != CANARY)
-		{
-			HTL_ASSERT("Invalid End Canary")
-		}
-	}
-#endif
-
-	// Check for possible pointer errors
-	void ValidateMemoryPointer(uintptr_t memory) const
-	{
-		if (reinterpret_cast<void*>(memory) == nullptr)
-		{
-			HTL_ASSERT("Invalid Pointer, couldn't free memory")
-		}
-		else if (memory < mBegin || memory > mEnd)
-		{
-			HTL_ASSERT("Pointer not in range of reserved space, couldn't free memory")
-		}
-	}
-
-	static void WriteMeta(uintptr_t alignedAddress, uintptr_t lastItem, size_t allocatedSize)
-	{
-		uintptr_t metaAddress = alignedAddress - META_SIZE;
-		//HTL_DEBUG("metaAddress: [%llx]", metaAddress);
-		*reinterpret_cast<MetaData*>(metaAddress) = MetaData(lastItem, allocatedSize);
-	}
-
-	static uintptr_t AlignUp(uintptr_t address, size_t alignment)
-	{
-		uintptr_t adjust = address % alignment; // Needed adjustment bits
-		if (adjust == 0)
-		{
-			return address;
-		}
-		//HTL_DEBUG("[Info]: needed adjustment bits: [%llu]", adjust);
-		return (address + (alignment - adjust));
-	}
-
-	static uintptr_t AlignDown(uintptr_t address, size_t alignment)
-	{
-		//uintptr_t adjust = address % alignment; // Needed adjustment bits
-		//HTL_DEBUG("[Info]: needed adjustment bits: [%llu], adjust);
-		return (address - (address % alignment));
-	}
-
-	void FreeMemoryAndUpdatePointer(uintptr_t pointerToFree, uintptr_t& pointerToUpdate)
-	{
-		// LIFO check
-		if (pointerToFree != pointerToUpdate)
-		{
-			ValidateMemoryPointer(pointerToFree);
-			HTL_ASSERT("Pointer doesn't match last allocated memory, couldn't free memory")
-			return;
-		}
-
-		MetaData* currentMetadata = GetMetaData(pointerToFree);
-
-#if WITH_DEBUG_CANARIES
-		CheckCanaries(pointerToFree, currentMetadata->Size);
-#endif
-
-		// We don't care what the user has written in the memory, therefore we just set the pointer to LastItem and "ignore" the previously allocated memory
-		pointerToUpdate = currentMetadata->LastItem;
-	}
-
-	// We use a struct to save metadata, for easier save/write and possible adjustments
-	struct MetaData
-	{
-		MetaData(uintptr_t lastItem, size_t size)
-			: LastItem(lastItem)
-			, Size(size)
-		{
-		}
-		uintptr_t LastItem;
-		size_t Size;
-	};
-
-	static MetaData* GetMetaData(uintptr_t allocSpacePtr)
-	{
-		MetaData* data = reinterpret_cast<MetaData*>(allocSpacePtr - META_SIZE);
-		// @Vogl How could we verify that MetaData struct is not corrupted?
-
-		// Possible ideas form our side:	Check if size is < (mEnd - mBegin)
-		//									LastItem needs to point to pointer in range (mBegin - mEnd)
-		//									LastItem needs to have valid meta data
-		return data;
-	}
-
-#if WITH_DEBUG_CANARIES
-	//static const uint32_t CANARY = 0xDEADC0DE;
-	static const uint32_t CANARY = 0xDEC0ADDE;	// Reverse, because little/big endian
-	static const ptrdiff_t CANARY_SIZE = sizeof(CANARY);
-#else
-	static const ptrdiff_t CANARY_SIZE = 0;
-#endif
-
-	static const ptrdiff_t META_SIZE = sizeof(MetaData);
-
-	// Boundaries of our allocation
-	uintptr_t mBegin = 0;
-	uintptr_t mEnd = 0;
-
-	// Decision: (A) using pointer to next/prev free memory or (B) points to user space begin
-	// --> (B) because this makes the LIFO check easier
-	uintptr_t mFront = 0;
-	uintptr_t mBack = 0;
-
-#if HTL_ALLOW_GROW
-	static const size_t DEFAULT_ALLOC_SIZE = 1024 * 1024 * 1024; // Arbitrary maximum size of reserved virtual memory, for malloc using ctor param max_size
-	DWORD mPageSize = 0; // Size of commitable pages in virtual memory
-
-	uintptr_t mPageEnd = 0; // End of committed pages for front
-	uintptr_t mPageStart = 0; // Begin of commited pages for back
-#endif
-};
+#include "DoubleEndedStackAllocator.h"
 
 // Mini-Visualization of our Double Ended Stack for better understanding
 //					|	|	|	|
@@ -760,6 +260,633 @@ int main()
 						&& alloc.Back() == alloc.End();
 				}());
 			}
+			{
+				DoubleEndedStackAllocator alloc(1024U);
+				Tests::Test_Case_Success("Verify ResetFront/ResetBack Success", [&alloc]()
+				{
+					alloc.Allocate(sizeof(uint32_t), 2);
+					void* back = alloc.AllocateBack(sizeof(uint32_t), 2);
+					alloc.ResetFront();
+					bool frontReset = alloc.Front() == alloc.Begin() && alloc.Back() == back;
+					alloc.ResetBack();
+					return frontReset
+						&& alloc.Back() == alloc.End();
+				}());
+			}
+			{
+				DoubleEndedStackAllocator alloc(1024U);
+				Tests::Test_Case_Success("Verify ResetValidated Success", [&alloc]()
+				{
+					alloc.Allocate(sizeof(uint32_t), 2);
+					alloc.Allocate(sizeof(uint32_t), 2);
+					alloc.AllocateBack(sizeof(uint32_t), 2);
+					alloc.AllocateBack(sizeof(uint32_t), 2);
+					alloc.ResetValidated();
+					return alloc.Front() == alloc.Begin()
+						&& alloc.Back() == alloc.End();
+				}());
+			}
+			{
+				DoubleEndedStackAllocator alloc(1024U);
+				Tests::Test_Case_Success("Verify FreeToMarker Success", [&alloc]()
+				{
+					void* alloc1 = alloc.Allocate(sizeof(uint32_t), 2);
+					void* back1 = alloc.AllocateBack(sizeof(uint32_t), 2);
+					DoubleEndedStackAllocator::Marker frontMarker = alloc.GetFrontMarker();
+					DoubleEndedStackAllocator::Marker backMarker = alloc.GetBackMarker();
+					alloc.Allocate(sizeof(uint32_t), 8);
+					alloc.Allocate(sizeof(uint32_t), 16);
+					alloc.AllocateBack(sizeof(uint32_t), 8);
+					alloc.AllocateBack(sizeof(uint32_t), 16);
+					alloc.FreeToMarker(frontMarker);
+					alloc.FreeToMarker(backMarker);
+					return alloc.Front() == alloc1
+						&& alloc.Back() == back1;
+				}());
+			}
+			{
+				DoubleEndedStackAllocator alloc(1024U);
+				Tests::Test_Case_Success("Verify ScopedFrontFrame/ScopedBackFrame Success", [&alloc]()
+				{
+					void* alloc1 = alloc.Allocate(sizeof(uint32_t), 2);
+					{
+						ScopedFrontFrame frontFrame(alloc);
+						ScopedBackFrame backFrame(alloc);
+						alloc.Allocate(sizeof(uint32_t), 2);
+						alloc.AllocateBack(sizeof(uint32_t), 2);
+					}
+					return alloc.Front() == alloc1
+						&& alloc.Back() == alloc.End();
+				}());
+			}
+			{
+				FrameArenaAllocator alloc(1024U);
+				Tests::Test_Case_Success("Verify FrameArena header-less Allocation Success", [&alloc]()
+				{
+					char* alloc1 = static_cast<char*>(alloc.Allocate(sizeof(uint64_t), 1));
+					FrameArenaAllocator::Marker marker = alloc.GetFrontMarker();
+					char* alloc2 = static_cast<char*>(alloc.Allocate(sizeof(uint64_t), 1));
+					char* back1 = static_cast<char*>(alloc.AllocateBack(sizeof(uint64_t), 1));
+					char* back2 = static_cast<char*>(alloc.AllocateBack(sizeof(uint64_t), 1));
+					alloc.FreeToMarker(marker);
+					char* alloc3 = static_cast<char*>(alloc.Allocate(sizeof(uint64_t), 1));
+					return FrameArenaAllocator::GetCanaraySize() == 0
+						&& FrameArenaAllocator::GetMetaSize() == 0
+						&& alloc1 == alloc.Begin()
+						&& alloc2 == alloc1 + sizeof(uint64_t)
+						&& back1 + sizeof(uint64_t) == alloc.End()
+						&& back2 + sizeof(uint64_t) == back1
+						&& alloc3 == alloc2;
+				}());
+			}
+			{
+				DoubleEndedStackAllocatorT<NoBoundsCheck, SideTableMetaData, DefaultGrowthPolicy, DefaultErrorPolicy> alloc(4096U);
+				Tests::Test_Case_Success("Verify side table Free Success", [&alloc]()
+				{
+					bool ret = true;
+					char* allocs[128];
+					for (size_t i = 0; i < 128; ++i) // More than the initial side table capacity
+					{
+						allocs[i] = static_cast<char*>(alloc.Allocate(sizeof(uint64_t), 1));
+						ret &= i == 0 || allocs[i] == allocs[i - 1] + sizeof(uint64_t);
+					}
+					// A record is a 32 bit distance and a 32 bit size
+					ret &= alloc.GetStats().MetaTableBytes == 128 * 8;
+					for (size_t i = 128; i > 64; --i)
+					{
+						alloc.Free(allocs[i - 1]);
+					}
+					void* back = alloc.AllocateBack(sizeof(uint64_t), 8);
+					alloc.FreeBack(back);
+					return ret
+						&& alloc.Front() == allocs[63]
+						&& alloc.Allocate(sizeof(uint64_t), 1) == allocs[64]
+						&& alloc.Back() == alloc.End();
+				}());
+			}
+			{
+				PackedStackAllocator alloc(1024U);
+				Tests::Test_Case_Success("Verify side table FreeToMarker Success", [&alloc]()
+				{
+					void* alloc1 = alloc.Allocate(sizeof(uint32_t), 4);
+					PackedStackAllocator::Marker marker = alloc.GetFrontMarker();
+					alloc.Allocate(sizeof(uint32_t), 4);
+					alloc.Allocate(sizeof(uint32_t), 4);
+					alloc.FreeToMarker(marker);
+					alloc.Free(alloc1);
+					return PackedStackAllocator::GetMetaSize() == 0
+						&& alloc.Front() == alloc.Begin();
+				}());
+			}
+			{
+				Tests::Test_Case_Success("Verify per-thread allocators Success", []()
+				{
+					const size_t threadCount = 4;
+					DoubleEndedStackAllocator::ConfigureThreadArenas(64 * 1024, threadCount * 2);
+
+					std::atomic<bool> ret(true);
+					std::atomic<size_t> arrived(0);
+					const void* begins[threadCount] = {};
+					std::thread threads[threadCount];
+					for (size_t i = 0; i < threadCount; ++i)
+					{
+						threads[i] = std::thread([&ret, &arrived, &begins, i]()
+						{
+							DoubleEndedStackAllocator& alloc = DoubleEndedStackAllocator::ThisThread();
+							for (size_t j = 0; j < 64; ++j)
+							{
+								uint32_t* mem = static_cast<uint32_t*>(alloc.Allocate(sizeof(uint32_t), 4));
+								*mem = static_cast<uint32_t>(i);
+								ret = ret && mem != nullptr && &alloc == &DoubleEndedStackAllocator::ThisThread();
+							}
+							begins[i] = alloc.Begin();
+
+							// Keep all threads alive until every thread got its instance, exited threads hand their slice to the next one
+							++arrived;
+							while (arrived < threadCount)
+							{
+								std::this_thread::yield();
+							}
+						});
+					}
+					for (size_t i = 0; i < threadCount; ++i)
+					{
+						threads[i].join();
+					}
+
+					DoubleEndedStackAllocator& alloc = DoubleEndedStackAllocator::ThisThread();
+					alloc.Allocate(sizeof(uint32_t), 4);
+					DoubleEndedStackAllocator::ResetAll();
+					for (size_t i = 0; i < threadCount; ++i)
+					{
+						for (size_t j = i + 1; j < threadCount; ++j)
+						{
+							ret = ret && begins[i] != nullptr && begins[i] != begins[j];
+						}
+					}
+					return ret
+						&& alloc.Front() == alloc.Begin();
+				}());
+			}
+			{
+				Tests::Test_Case_Success("Verify malloc thread arenas use small default slices Success", []()
+				{
+					// All slices are malloc'ed at once, the virtual memory default would be a 4 GiB malloc
+					using MallocArena = DoubleEndedStackAllocatorT<NoBoundsCheck, InlineMetaData, MallocGrowth, IgnoreErrors>;
+					MallocArena& alloc = MallocArena::ThisThread();
+					void* memory = alloc.Allocate(64, 8);
+					size_t size = static_cast<const char*>(alloc.End()) - static_cast<const char*>(alloc.Begin());
+					MallocArena::ResetAll();
+					return memory && size == MallocGrowth::DEFAULT_SLICE_SIZE && size < VirtualMemoryGrowth::DEFAULT_SLICE_SIZE;
+				}());
+			}
+			{
+				ConcurrentDoubleEndedStackAllocator alloc(64U * 1024U);
+				Tests::Test_Case_Success("Verify concurrent Allocation Success", [&alloc]()
+				{
+					const size_t threadCount = 4;
+					const size_t allocCount = 256;
+					uint32_t* allocs[threadCount][allocCount] = {};
+					std::thread threads[threadCount];
+					for (size_t i = 0; i < threadCount; ++i)
+					{
+						threads[i] = std::thread([&alloc, &allocs, i]()
+						{
+							for (size_t j = 0; j < allocCount; ++j)
+							{
+								// Both ends are filled concurrently
+								void* mem = (j % 2) ? alloc.AllocateBack(sizeof(uint32_t) * 4, 8) : alloc.Allocate(sizeof(uint32_t) * 4, 8);
+								allocs[i][j] = static_cast<uint32_t*>(mem);
+								for (size_t k = 0; k < 4; ++k)
+								{
+									allocs[i][j][k] = static_cast<uint32_t>(i * allocCount + j);
+								}
+							}
+						});
+					}
+					for (size_t i = 0; i < threadCount; ++i)
+					{
+						threads[i].join();
+					}
+
+					// Overlapping allocations would have overwritten each others pattern
+					bool ret = alloc.GetUsedSize() >= threadCount * allocCount * sizeof(uint32_t) * 4;
+					for (size_t i = 0; i < threadCount; ++i)
+					{
+						for (size_t j = 0; j < allocCount; ++j)
+						{
+							for (size_t k = 0; k < 4; ++k)
+							{
+								ret &= allocs[i][j][k] == i * allocCount + j;
+							}
+						}
+					}
+					alloc.Reset();
+					return ret
+						&& alloc.GetUsedSize() == 0;
+				}());
+			}
+			{
+				DoubleEndedStackAllocator alloc(1024U);
+				Tests::Test_Case_Success("Verify compile-time Allocate<T> Success", [&alloc]()
+				{
+					struct alignas(32) Vec { float Data[8]; };
+					alloc.Allocate(1, 1);
+					Vec* front = alloc.Allocate<Vec>();
+					Vec* back = alloc.AllocateBack<Vec>();
+					void* raw = alloc.Allocate<24, 16>();
+					return front != nullptr && back != nullptr && raw != nullptr
+						&& reinterpret_cast<uintptr_t>(front) % alignof(Vec) == 0
+						&& reinterpret_cast<uintptr_t>(back) % alignof(Vec) == 0
+						&& reinterpret_cast<uintptr_t>(raw) % 16 == 0
+						&& alloc.Front() == raw
+						&& alloc.Back() == back;
+				}());
+			}
+			{
+				DoubleEndedStackAllocator alloc(4096U);
+				Tests::Test_Case_Success("Verify STL containers on front and back stack Success", [&alloc]()
+				{
+					bool ret = true;
+					{
+						std::vector<uint32_t, StackAllocatorAdapter<uint32_t>> front{ StackAllocatorAdapter<uint32_t>(alloc) };
+						std::basic_string<char, std::char_traits<char>, StackAllocatorAdapter<char, End::Back>> back{ StackAllocatorAdapter<char, End::Back>(alloc) };
+						for (uint32_t i = 0; i < 100; ++i)
+						{
+							// Growing reallocates, the old buffers are not on top anymore and get deferred
+							front.push_back(i);
+							back.push_back(static_cast<char>('a' + i % 26));
+						}
+						uintptr_t data = reinterpret_cast<uintptr_t>(front.data());
+						uintptr_t text = reinterpret_cast<uintptr_t>(back.data());
+						ret &= data >= reinterpret_cast<uintptr_t>(alloc.Begin()) && text < reinterpret_cast<uintptr_t>(alloc.End())
+							&& data < text && front[99] == 99 && back[27] == 'b';
+					}
+					// Deferred buffers stay until the reset
+					ret &= alloc.GetUsedSize() > 0;
+					alloc.Reset();
+					return ret
+						&& alloc.GetUsedSize() == 0;
+				}());
+			}
+#if HTL_HAS_PMR
+			{
+				DoubleEndedStackAllocator alloc(8192U);
+				Tests::Test_Case_Success("Verify pmr containers on stack memory resource Success", [&alloc]()
+				{
+					FrontStackMemoryResource resource(alloc);
+					bool ret = true;
+					{
+						std::pmr::unordered_map<int, int> map(&resource);
+						for (int i = 0; i < 64; ++i)
+						{
+							map[i] = i * 2;
+						}
+						ret &= map.size() == 64 && map[63] == 126 && alloc.Front() != alloc.Begin();
+					}
+					alloc.Reset();
+					return ret
+						&& alloc.GetUsedSize() == 0;
+				}());
+			}
+#endif // HTL_HAS_PMR
+			{
+				DoubleEndedStackAllocator alloc(1024U);
+				Tests::Test_Case_Success("Verify Reallocate in place Success", [&alloc]()
+				{
+					char* front = static_cast<char*>(alloc.Allocate(4, 4));
+					memcpy(front, "abc", 4);
+					char* grown = static_cast<char*>(alloc.Reallocate(front, 200, 4));
+					char* back = static_cast<char*>(alloc.AllocateBack(4, 4));
+					memcpy(back, "xyz", 4);
+					char* grownBack = static_cast<char*>(alloc.ReallocateBack(back, 100, 4));
+					bool ret = grown == front && strcmp(grown, "abc") == 0
+						&& grownBack < back && strcmp(grownBack, "xyz") == 0
+						&& alloc.Front() == grown && alloc.Back() == grownBack;
+					// Canaries and meta data have to match the new sizes
+					alloc.FreeBack(grownBack);
+					alloc.Free(grown);
+					return ret
+						&& alloc.GetUsedSize() == 0;
+				}());
+			}
+			{
+				DoubleEndedStackAllocator alloc(1024U);
+				Tests::Test_Case_Success("Verify Reallocate by copy Success", [&alloc]()
+				{
+					uint32_t* first = static_cast<uint32_t*>(alloc.Allocate(sizeof(uint32_t) * 2, 4));
+					first[0] = 1;
+					first[1] = 2;
+					alloc.Allocate(8, 8);
+					uint32_t* moved = static_cast<uint32_t*>(alloc.Reallocate(first, sizeof(uint32_t) * 4, 4));
+					return moved != first && alloc.Front() == moved
+						&& moved[0] == 1 && moved[1] == 2;
+				}());
+			}
+			{
+				DoubleEndedStackAllocator alloc(1024U);
+				Tests::Test_Case_Success("Verify Reallocate to a larger alignment moves Success", [&alloc]()
+				{
+					// The next allocation is less than 256 bytes away, so at most one of them is 256 byte aligned
+					uintptr_t small = reinterpret_cast<uintptr_t>(alloc.Allocate(8, 8));
+					if (small % 256 == 0)
+					{
+						small = reinterpret_cast<uintptr_t>(alloc.Allocate(8, 8));
+					}
+					uintptr_t grown = reinterpret_cast<uintptr_t>(alloc.Reallocate(reinterpret_cast<void*>(small), 16, 256));
+					return grown && grown % 256 == 0 && grown != small && alloc.Front() == reinterpret_cast<void*>(grown);
+				}());
+			}
+			{
+				DoubleEndedStackAllocator alloc(1024U);
+				Tests::Test_Case_Success("Verify AllocateArray and AllocateBatch Success", [&alloc]()
+				{
+					uintptr_t array = reinterpret_cast<uintptr_t>(alloc.AllocateArray(10, 12, 8));
+					const size_t sizes[3] = { 3, 20, 8 };
+					void* blocks[3] = {};
+					void* group = alloc.AllocateBatchBack(sizes, 3, 16, blocks);
+					uintptr_t block1 = reinterpret_cast<uintptr_t>(blocks[1]);
+					uintptr_t block2 = reinterpret_cast<uintptr_t>(blocks[2]);
+					bool ret = array % 8 == 0 && alloc.Front() == reinterpret_cast<void*>(array)
+						&& group == blocks[0] && alloc.Back() == group
+						&& block1 == reinterpret_cast<uintptr_t>(group) + 16 && block2 == block1 + 32;
+					// One allocation record per group
+					alloc.FreeBack(group);
+					alloc.Free(reinterpret_cast<void*>(array));
+					return ret
+						&& alloc.GetUsedSize() == 0;
+				}());
+			}
+			{
+				DoubleEndedStackAllocatorT<DefaultBoundsCheckPolicy, InlineMetaData, DefaultGrowthPolicy, DefaultErrorPolicy, CollectStats> alloc(1024U);
+				Tests::Test_Case_Success("Verify allocation statistics Success", [&alloc]()
+				{
+					void* front1 = alloc.Allocate(10, 8);
+					void* front2 = alloc.Allocate(20, 16);
+					alloc.AllocateBack(30, 4);
+					size_t frontPeak = alloc.GetUsedSize() - alloc.GetStats().LiveBytes[static_cast<int>(End::Back)];
+					alloc.Free(front2);
+					alloc.Free(front1);
+
+					AllocatorStats stats = alloc.GetStats();
+					size_t overhead = stats.PaddingBytes + stats.CanaryBytes + stats.MetaBytes;
+					return stats.LiveBytes[static_cast<int>(End::Front)] == 0
+						&& stats.PeakBytes[static_cast<int>(End::Front)] == frontPeak
+						&& stats.AllocationCount[static_cast<int>(End::Front)] == 2 && stats.AllocationCount[static_cast<int>(End::Back)] == 1
+						&& stats.FreeCount[static_cast<int>(End::Front)] == 2 && stats.RequestedBytes == 60
+						&& stats.RequestedBytes + overhead == frontPeak + stats.LiveBytes[static_cast<int>(End::Back)]
+						&& stats.CommittedBytes <= stats.ReservedBytes;
+				}());
+			}
+			{
+				DoubleEndedStackAllocatorT<DefaultBoundsCheckPolicy, InlineMetaData, DefaultGrowthPolicy, DefaultErrorPolicy, NoStats, RingBufferTrace> alloc(1024U);
+				Tests::Test_Case_Success("Verify allocation trace Success", [&alloc]()
+				{
+					void* front = alloc.Allocate(12, 4);
+					alloc.AllocateBack(40, 8);
+					alloc.Free(front);
+					alloc.ResetBack();
+
+					TraceEvent events[8];
+					size_t count = alloc.GetTrace().Drain(events, 8);
+					return count == 4 && alloc.GetTrace().Drain(events, 8) == 0
+						&& events[0].Op == static_cast<uint8_t>(TraceOp::Allocate) && events[0].Size == 12 && events[0].Alignment == 4
+						&& events[1].Side == static_cast<uint8_t>(End::Back) && events[1].Size == 40
+						&& events[2].Op == static_cast<uint8_t>(TraceOp::Free) && events[3].Op == static_cast<uint8_t>(TraceOp::Reset)
+						&& events[0].Timestamp <= events[3].Timestamp
+						&& alloc.GetTrace().GetDropped() == 0;
+				}());
+			}
+			{
+				DoubleEndedStackAllocator alloc(1024U);
+				Tests::Test_Case_Success("Verify TryAllocate error codes Success", [&alloc]()
+				{
+					AllocationResult ok = alloc.TryAllocate(16, 8);
+					AllocationResult full = alloc.TryAllocateBack(SIZE_MAX / 2, 8);
+					AllocationResult badAlignment = alloc.TryAllocate(16, 3);
+					AllocationResult empty = alloc.TryAllocateBack(0, 8);
+					return ok && ok.Error == AllocatorError::None && alloc.Front() == ok.Memory
+						&& !full && full.Error == AllocatorError::Overlap
+						&& badAlignment.Error == AllocatorError::InvalidAlignment
+						&& empty.Error == AllocatorError::InvalidSize;
+				}());
+			}
+			{
+				static AllocatorError lastError = AllocatorError::None;
+				DoubleEndedStackAllocatorT<DefaultBoundsCheckPolicy, InlineMetaData, DefaultGrowthPolicy, HandlerErrors> alloc(1024U);
+				Tests::Test_Case_Success("Verify installable error handler Success", [&alloc]()
+				{
+					HandlerErrors::SetHandler([](AllocatorError error, const char*) { lastError = error; });
+					void* ptr = alloc.Allocate(16, 8);
+					alloc.Allocate(16, 8);
+					alloc.Free(ptr);
+					AllocatorError freeError = lastError;
+					alloc.Allocate(16, 5);
+					HandlerErrors::SetHandler(nullptr);
+					return freeError == AllocatorError::NotLastAllocation
+						&& lastError == AllocatorError::InvalidAlignment;
+				}());
+			}
+			{
+				HardenedStackAllocator alloc(1024U);
+				Tests::Test_Case_Success("Verify compact meta data Success", [&alloc]()
+				{
+					void* front1 = alloc.Allocate(20, 4);
+					void* front2 = alloc.Allocate(100, 64);
+					void* back1 = alloc.AllocateBack(30, 8);
+					void* back2 = alloc.AllocateBack(12, 16);
+					void* grown = alloc.ReallocateBack(back2, 40, 16);
+					alloc.FreeBack(grown);
+					bool backFreed = alloc.Back() == back1;
+					alloc.FreeBack(back1);
+					alloc.Free(front2);
+					bool frontFreed = alloc.Front() == front1;
+					alloc.Free(front1);
+					return HardenedStackAllocator::GetMetaSize() == 8 && grown && backFreed && frontFreed
+						&& alloc.Front() == alloc.Begin() && alloc.Back() == alloc.End();
+				}());
+			}
+			{
+				HardenedStackAllocator alloc(1024U);
+				Tests::Test_Case_Success("Verify hardened allocator overhead is the header Success", [&alloc]()
+				{
+					char* first = static_cast<char*>(alloc.Allocate(16, 8));
+					char* second = static_cast<char*>(alloc.Allocate(24, 8));
+					alloc.AllocateBack(32, 8);
+					return HardenedStackAllocator::GetCanaraySize() == 0 && second - first == 16 + 8
+						&& alloc.GetUsedSize() == 16 + 24 + 32 + 3 * 8;
+				}());
+			}
+			{
+				static AllocatorError lastError = AllocatorError::None;
+				DoubleEndedStackAllocatorT<NoBoundsCheck, CompactMetaData, DefaultGrowthPolicy, HandlerErrors> alloc(1024U);
+				Tests::Test_Case_Success("Verify corrupted compact meta data is detected Success", [&alloc]()
+				{
+					HandlerErrors::SetHandler([](AllocatorError error, const char*) { lastError = error; });
+					char* first = static_cast<char*>(alloc.Allocate(16, 8));
+					char* second = static_cast<char*>(alloc.Allocate(16, 8));
+					// Overflow of the first allocation flips a single bit in the header of the second one
+					first[second - first - 3] ^= 0x10;
+					alloc.Free(second);
+					HandlerErrors::SetHandler(nullptr);
+					return lastError == AllocatorError::CorruptedMetaData && alloc.Front() == second;
+				}());
+			}
+			{
+				static size_t corruptions = 0;
+				DoubleEndedStackAllocatorT<NoBoundsCheck, CompactMetaData, DefaultGrowthPolicy, HandlerErrors> alloc(1024U);
+				Tests::Test_Case_Success("Verify validated reset stops at corrupted meta data Success", [&alloc]()
+				{
+					HandlerErrors::SetHandler([](AllocatorError error, const char*) { corruptions += error == AllocatorError::CorruptedMetaData ? 1 : 0; });
+					char* first = static_cast<char*>(alloc.Allocate(16, 8));
+					char* second = static_cast<char*>(alloc.Allocate(16, 8));
+					char* back = static_cast<char*>(alloc.AllocateBack(16, 8));
+					first[second - first - 3] ^= 0x10;
+					back[-3] ^= 0x10;
+					alloc.ResetValidated();
+					HandlerErrors::SetHandler(nullptr);
+					return corruptions == 2 && alloc.Front() == alloc.Begin() && alloc.Back() == alloc.End();
+				}());
+			}
+			{
+				DoubleEndedStackAllocator alloc(1024U);
+				Tests::Test_Case_Success("Verify New runs destructors in reverse order Success", [&alloc]()
+				{
+					struct Tracked
+					{
+						explicit Tracked(std::string& log, char name) : Log(log), Name(name) {}
+						~Tracked() { Log += Name; }
+						std::string& Log;
+						char Name;
+					};
+
+					std::string log;
+					Tracked* a = alloc.New<Tracked>(log, 'a');
+					uint64_t* plain = alloc.New<uint64_t>(42U);
+					bool bump = alloc.Front() == plain && *plain == 42U
+						&& reinterpret_cast<uintptr_t>(plain) - reinterpret_cast<uintptr_t>(a) < sizeof(Tracked) + sizeof(DestructorRecord) + 2 * alloc.GetCanaraySize() + alloc.GetMetaSize() + 8;
+					alloc.Free(plain);
+					auto marker = alloc.GetFrontMarker();
+					alloc.New<Tracked>(log, 'b');
+					alloc.New<Tracked>(log, 'c');
+					alloc.FreeToMarker(marker);
+					std::string afterMarker = log;
+
+					alloc.NewBack<Tracked>(log, 'd');
+					std::string* names = alloc.NewArrayBack<std::string>(3);
+					bool valueInitialized = names[0].empty() && names[1].empty();
+					names[2] = "long enough to need memory of its own, released by its destructor";
+					alloc.Free(a);
+					alloc.Reset();
+					return a && bump && valueInitialized && afterMarker == "cb" && log == "cbad";
+				}());
+			}
+			{
+				static size_t destroyed = 0;
+				DoubleEndedStackAllocatorT<NoBoundsCheck, NoMetaData, MallocGrowth, IgnoreErrors> alloc(1024U);
+				Tests::Test_Case_Success("Verify rejected Free keeps New objects alive Success", [&alloc]()
+				{
+					struct Counted
+					{
+						~Counted() { ++destroyed; }
+						uint64_t Payload;
+					};
+
+					Counted* front = alloc.New<Counted>();
+					Counted* back = alloc.NewBack<Counted>();
+					// Without meta data every Free is rejected, the objects still live in allocated memory
+					alloc.Free(front);
+					alloc.FreeBack(back);
+					size_t afterFree = destroyed;
+					alloc.Reset();
+					return front && back && afterFree == 0 && destroyed == 2;
+				}());
+			}
+			{
+				SpillingStackAllocator alloc(1024U, 4096U);
+				Tests::Test_Case_Success("Verify heap fallback spill Success", [&alloc]()
+				{
+					void* front = alloc.Allocate(64, 8);
+					void* spill = alloc.Allocate(8000, 64);
+					memset(spill, 0xAB, 8000);
+					void* back = alloc.AllocateBack(16, 8);
+					alloc.AllocateBack(8000, 16);
+					bool placed = back == alloc.Back() && front == alloc.Front()
+						&& (spill < alloc.Begin() || spill >= alloc.End()) && reinterpret_cast<uintptr_t>(spill) % 64 == 0;
+
+					void* grown = alloc.Reallocate(spill, 9000, 64);
+					bool copied = grown && static_cast<unsigned char*>(grown)[7999] == 0xAB;
+					alloc.Free(grown);
+					alloc.Free(front);
+					AllocatorStats stats = alloc.GetStats();
+					alloc.Reset();
+					return placed && copied && alloc.Front() == alloc.Begin()
+						&& stats.SpillCount == 3 && stats.SpillBytes == 25000;
+				}());
+			}
+			{
+				static size_t destroyed = 0;
+				SpillingStackAllocator alloc(1024U, 4096U);
+				Tests::Test_Case_Success("Verify TryFree of a spilled New Success", [&alloc]()
+				{
+					struct Counted
+					{
+						~Counted() { ++destroyed; }
+						char Payload[200];
+					};
+
+					Counted* spilled = alloc.NewArray<Counted>(40);
+					bool isSpill = spilled && (static_cast<void*>(spilled) < alloc.Begin() || static_cast<void*>(spilled) >= alloc.End());
+					bool freed = alloc.TryFree(spilled);
+					size_t afterFree = destroyed;
+					alloc.Reset();
+					return isSpill && freed && afterFree == 40 && destroyed == 40;
+				}());
+			}
+			{
+				SegmentedStackAllocator alloc(1024U, 4096U);
+				alloc.GetFallback().SetChunkSize(64 * 1024);
+				Tests::Test_Case_Success("Verify segmented fallback chunks Success", [&alloc]()
+				{
+					void* spill = alloc.Allocate(8000, 16);
+					bool freed = alloc.TryFree(spill);
+					void* again = alloc.Allocate(8000, 16);
+					void* back = alloc.AllocateBack(8000, 16);
+					void* large = alloc.Allocate(128 * 1024, 16);
+					memset(large, 1, 128 * 1024);
+					AllocatorStats stats = alloc.GetStats();
+					alloc.Free(large);
+					alloc.Free(again);
+					size_t unwound = alloc.GetStats().ChunkCount;
+					alloc.Reset();
+					return spill && freed && again == spill && back && large
+						&& stats.SpillCount == 4 && stats.ChunkCount == 3
+						&& unwound == 1 && alloc.GetStats().ChunkCount == 0;
+				}());
+			}
+			{
+				SegmentedStackAllocator alloc(1024U, 4096U);
+				alloc.GetFallback().SetChunkSize(64 * 1024);
+				Tests::Test_Case_Success("Verify segmented chunks stay LIFO and unwind with markers Success", [&alloc]()
+				{
+					void* below = alloc.Allocate(16, 8);
+					auto marker = alloc.GetFrontMarker();
+					char* spill = static_cast<char*>(alloc.Allocate(8000, 16));
+					// The stack has room for this one, but it has to follow the spill
+					char* small = static_cast<char*>(alloc.Allocate(16, 8));
+					bool chained = small > spill && small < spill + 64 * 1024 && alloc.Front() == below;
+					alloc.Free(below);
+					bool rejected = alloc.Front() == below;
+					{
+						ScopedFrame<SegmentedStackAllocator, End::Front> frame(alloc);
+						alloc.Allocate(128 * 1024, 16);
+					}
+					size_t afterFrame = alloc.GetStats().ChunkCount;
+					alloc.FreeToMarker(marker);
+					return chained && rejected && afterFrame == 1
+						&& alloc.GetStats().ChunkCount == 0 && alloc.Front() == below;
+				}());
+			}
 			{
 				DoubleEndedStackAllocator alloc(1024U);
 				Tests::Test_Case_Success("Verify Alloc after Free Success", [&alloc]()
@@ -814,6 +941,189 @@ int main()
 					return false;
 				}());
 			}
+			{
+				VirtualMemoryOptions options;
+				options.HugePages = true;
+				DoubleEndedStackAllocator alloc(1024U, options);
+				Tests::Test_Case_Success("Verify huge page reservation Success", [&alloc]()
+				{
+					// Falls back to normal pages if the system has no transparent huge pages
+					const size_t hugePageSize = alloc.UsesHugePages() ? VirtualMemory::GetHugePageSize() : 1;
+					void* front = alloc.Allocate(3 * 1024 * 1024, 64);
+					void* back = alloc.AllocateBack(3 * 1024 * 1024, 64);
+					return front != nullptr && back != nullptr
+						&& reinterpret_cast<uintptr_t>(alloc.Begin()) % hugePageSize == 0
+						&& alloc.GetCommittedSize() % hugePageSize == 0;
+				}());
+			}
+			{
+				VirtualMemoryOptions options;
+				options.CommitGranule = 16 * pageSize;
+				DoubleEndedStackAllocator alloc(1024U, options);
+				Tests::Test_Case_Success("Verify commit granule Success", [&alloc, pageSize]()
+				{
+					// First page of each stack is committed up front, the rest in one granule
+					alloc.Allocate(pageSize, 8);
+					return alloc.GetCommittedSize() == 18 * pageSize;
+				}());
+			}
+			{
+				VirtualMemoryOptions options;
+				options.GeometricCommit = true;
+				DoubleEndedStackAllocator alloc(1024U, options);
+				Tests::Test_Case_Success("Verify geometric commit growth Success", [&alloc, pageSize]()
+				{
+					// Commits 8 pages, then twice the last commit (16 pages) which also covers the third allocation
+					alloc.Allocate(8 * pageSize, 8);
+					alloc.Allocate(8 * pageSize, 8);
+					size_t committed = alloc.GetCommittedSize();
+					alloc.Allocate(8 * pageSize, 8);
+					return committed == 26 * pageSize
+						&& alloc.GetCommittedSize() == committed
+						&& alloc.GetCommitAheadSize() > 0;
+				}());
+			}
+			{
+				Tests::Test_Case_Success("Verify prewarm to watermark Success", [pageSize]()
+				{
+					VirtualMemoryOptions options;
+					{
+						DoubleEndedStackAllocator previousRun(1024U);
+						previousRun.Allocate(20 * pageSize, 8);
+						previousRun.AllocateBack(10 * pageSize, 8);
+						options.Prewarm = previousRun.GetCommitWatermark();
+					}
+					options.PrewarmAsync = true;
+					DoubleEndedStackAllocator alloc(1024U, options);
+					size_t committed = alloc.GetCommittedSize();
+					bool ret = alloc.Prewarm(4 * pageSize, 40 * pageSize);
+					return options.Prewarm.FrontBytes > 20 * pageSize && options.Prewarm.BackBytes > 10 * pageSize
+						&& committed >= options.Prewarm.FrontBytes + options.Prewarm.BackBytes
+						&& ret && alloc.GetCommitWatermark().BackBytes >= 40 * pageSize
+						&& alloc.Allocate(20 * pageSize, 8) != nullptr;
+				}());
+			}
+			{
+				DoubleEndedStackAllocatorT<GuardPageBoundsCheck, InlineMetaData, VirtualMemoryGrowth, DefaultErrorPolicy> alloc(1024U);
+				Tests::Test_Case_Success("Verify guard page placement and reuse Success", [&alloc, pageSize]()
+				{
+					const size_t size = 100000;
+					char* front = static_cast<char*>(alloc.Allocate(size, 16));
+					char* back = static_cast<char*>(alloc.AllocateBack(size, 16));
+					char* small = static_cast<char*>(alloc.Allocate(64, 16));
+					uintptr_t frontEnd = reinterpret_cast<uintptr_t>(front) + size;
+					uintptr_t backEnd = reinterpret_cast<uintptr_t>(back) + size;
+					bool flush = (pageSize - frontEnd % pageSize) % pageSize < 16 && (pageSize - backEnd % pageSize) % pageSize < 16
+						&& reinterpret_cast<uintptr_t>(small) >= frontEnd + pageSize;
+					memset(front, 1, size);
+					memset(back, 1, size);
+
+#if !defined(_WIN32)
+					// Writing the first byte behind the allocation has to fault
+					pid_t child = fork();
+					if (child == 0)
+					{
+						signal(SIGSEGV, SIG_DFL); // Sanitizers install their own handler
+						static_cast<volatile char*>(front)[(pageSize - frontEnd % pageSize) % pageSize + size] = 1;
+						_exit(0);
+					}
+					int status = 0;
+					waitpid(child, &status, 0);
+					flush = flush && WIFSIGNALED(status) && WTERMSIG(status) == SIGSEGV;
+#endif
+
+					// Freed guard pages are normal memory again
+					alloc.Free(small);
+					alloc.Free(front);
+					alloc.FreeBack(back);
+					char* reuse = static_cast<char*>(alloc.Allocate(60000, 16));
+					char* reuse2 = static_cast<char*>(alloc.Allocate(60000, 16));
+					memset(reuse, 2, 60000);
+					memset(reuse2, 2, 60000);
+					alloc.Reset();
+					return front && back && flush && reuse2 > reuse;
+				}());
+			}
+			{
+				DoubleEndedStackAllocatorT<ParanoidGuardPageBoundsCheck, InlineMetaData, VirtualMemoryGrowth, DefaultErrorPolicy> alloc(1024U);
+				Tests::Test_Case_Success("Verify paranoid guard pages Success", [&alloc, pageSize]()
+				{
+					void* first = alloc.Allocate(24, 8);
+					void* second = alloc.Allocate(24, 8);
+					void* grown = alloc.Reallocate(second, 48, 8);
+					alloc.Free(grown);
+					return first && second && (reinterpret_cast<uintptr_t>(second) + 24) % pageSize == 0
+						&& grown != second && reinterpret_cast<uintptr_t>(grown) - reinterpret_cast<uintptr_t>(second) >= pageSize
+						&& alloc.GetUsedSize() == 4 * pageSize;
+				}());
+			}
+			{
+				DoubleEndedStackAllocatorT<ParanoidGuardPageBoundsCheck, InlineMetaData, VirtualMemoryGrowth, DefaultErrorPolicy> alloc(1024U);
+				Tests::Test_Case_Success("Verify Prewarm skips guard pages Success", [&alloc, pageSize]()
+				{
+					char* front = static_cast<char*>(alloc.Allocate(24, 8));
+					char* back = static_cast<char*>(alloc.AllocateBack(24, 8));
+					memcpy(front, "front", 6);
+					memcpy(back, "back", 5);
+					bool prewarmed = alloc.Prewarm(64 * 1024, 64 * 1024) && alloc.Prewarm(16 * pageSize, 16 * pageSize, true);
+					void* next = alloc.Allocate(24, 8);
+					bool kept = strcmp(front, "front") == 0 && strcmp(back, "back") == 0;
+					alloc.Reset();
+					return prewarmed && next && kept;
+				}());
+			}
+			{
+				static AllocatorError lastError = AllocatorError::None;
+				// Compact headers store sizes below 4 GiB, the pages of a larger allocation are committed but never touched
+				const size_t tooLarge = static_cast<size_t>(UINT32_MAX) + 1;
+				DoubleEndedStackAllocatorT<NoBoundsCheck, CompactMetaData, VirtualMemoryGrowth, HandlerErrors> alloc(1024U, 4 * tooLarge);
+				Tests::Test_Case_Success("Verify Reallocate keeps the allocation if meta data can't be stored Success", [&alloc, tooLarge]()
+				{
+					HandlerErrors::SetHandler([](AllocatorError error, const char*) { lastError = error; });
+					char* front = static_cast<char*>(alloc.Allocate(16, 8));
+					char* back = static_cast<char*>(alloc.AllocateBack(16, 8));
+					memcpy(back, "back", 5);
+					void* grown = alloc.Reallocate(front, tooLarge, 8);
+					AllocatorError frontError = lastError;
+					void* grownBack = alloc.ReallocateBack(back, tooLarge, 8);
+					HandlerErrors::SetHandler(nullptr);
+					bool kept = alloc.Front() == front && alloc.Back() == back && strcmp(back, "back") == 0;
+					alloc.FreeBack(back);
+					alloc.Free(front);
+					return !grown && !grownBack && kept && frontError == AllocatorError::MetaDataFailed
+						&& lastError == AllocatorError::MetaDataFailed && alloc.GetUsedSize() == 0;
+				}());
+			}
+			{
+				Tests::Test_Case_Success("Verify current NUMA node commits Success", [pageSize]()
+				{
+					// Binding may be unsupported (no NUMA, containers), non strict binding must work anyway
+					VirtualMemoryOptions options;
+					options.NumaNode = VirtualMemoryOptions::NUMA_CURRENT_NODE;
+					DoubleEndedStackAllocator alloc(1024U, options, 64 * pageSize);
+					void* front = alloc.Allocate(8 * pageSize, 8);
+					void* back = alloc.AllocateBack(8 * pageSize, 8);
+					memset(front, 1, 8 * pageSize);
+					memset(back, 1, 8 * pageSize);
+					return front && back && alloc.GetCommittedSize() >= 16 * pageSize;
+				}());
+			}
+			{
+				Tests::Test_Case_Success("Verify one arena per NUMA node Success", [pageSize]()
+				{
+					NumaArenas<DoubleEndedStackAllocator> arenas(1024U, VirtualMemoryOptions(), 64 * pageSize);
+					bool allocated = true;
+					for (size_t node = 0; node < arenas.GetNodeCount(); ++node)
+					{
+						allocated &= arenas.ForNode(static_cast<int>(node)).Allocate(4 * pageSize, 8) != nullptr;
+					}
+					void* local = arenas.ThisNode().Allocate(64, 8);
+					arenas.ResetAll();
+					return arenas.GetNodeCount() >= 1 && allocated && local
+						&& &arenas.ForNode(-1) == &arenas.ForNode(0)
+						&& arenas.ForNode(0).GetUsedSize() == 0;
+				}());
+			}
 			{
 				DoubleEndedStackAllocator alloc(1024U);
 				Tests::Test_Case_Success("Verify dynamic front page reservation Success", [&alloc, allocSize, pageSize]()
@@ -840,6 +1150,30 @@ int main()
 					return true;
 				}());
 			}
+			{
+				DoubleEndedStackAllocator alloc(1024U);
+				Tests::Test_Case_Success("Verify decommit of unused pages Success", [&alloc, pageSize]()
+				{
+					DecommitPolicy policy;
+					policy.RetainBytes = pageSize;
+					policy.HysteresisBytes = pageSize;
+					alloc.SetDecommitPolicy(policy);
+
+					const size_t initialCommit = alloc.GetCommittedSize();
+					void* front = alloc.Allocate(pageSize * 8, 32);
+					void* back = alloc.AllocateBack(pageSize * 8, 32);
+					const size_t grownCommit = alloc.GetCommittedSize();
+					alloc.Free(front);
+					alloc.FreeBack(back);
+					const size_t shrunkCommit = alloc.GetCommittedSize();
+					// Memory has to be usable again after decommit
+					front = alloc.Allocate(pageSize * 8, 32);
+					static_cast<char*>(front)[pageSize * 8 - 1] = 1;
+					return grownCommit > initialCommit
+						&& shrunkCommit < grownCommit
+						&& shrunkCommit <= initialCommit + 2 * 2 * pageSize;
+				}());
+			}
 #endif
 		}
 
@@ -1070,6 +1404,45 @@ int main()
 					return alloc2 != alloc.Back();
 				}());
 			}
+			{
+				ConcurrentDoubleEndedStackAllocator alloc(64U);
+				Tests::Test_Case_Failure("Verify fail on concurrent Front Overlaps Back", [&alloc]()
+				{
+					void* alloc1 = alloc.Allocate(32, 1);
+					void* alloc2 = alloc.AllocateBack(32, 1);
+					void* alloc3 = alloc.Allocate(1, 1);
+					void* alloc4 = alloc.AllocateBack(1, 1);
+					return alloc1 == nullptr
+						|| alloc2 == nullptr
+						|| alloc3 != nullptr
+						|| alloc4 != nullptr;
+				}());
+			}
+			{
+				DoubleEndedStackAllocator alloc(1024U);
+				Tests::Test_Case_Failure("Verify fail on AllocateArray overflow", [&alloc]()
+				{
+					const size_t sizes[2] = { SIZE_MAX / 2, SIZE_MAX / 2 };
+					void* blocks[2] = {};
+					void* array = alloc.AllocateArray(SIZE_MAX / 2, 4, 4);
+					void* batch = alloc.AllocateBatch(sizes, 2, 4, blocks);
+					return array != nullptr
+						|| batch != nullptr;
+				}());
+			}
+			{
+				DoubleEndedStackAllocator alloc(1024U);
+				Tests::Test_Case_Failure("Verify fail on FreeToMarker with released marker", [&alloc]()
+				{
+					alloc.Allocate(sizeof(uint32_t), 2);
+					DoubleEndedStackAllocator::Marker marker = alloc.GetFrontMarker();
+					alloc.Reset();
+					void* ptr = alloc.Allocate(sizeof(uint32_t) * 4, 2);
+					alloc.Free(ptr);
+					alloc.FreeToMarker(marker);
+					return alloc.Front() != alloc.Begin();
+				}());
+			}
 #if WITH_DEBUG_CANARIES
 			{
 				DoubleEndedStackAllocator alloc(1024U);